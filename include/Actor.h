@@ -8,6 +8,29 @@
 #include "LuaBridge/LuaBridge.h"
 #include "ComponentManager.h"
 
+class Actor;
+
+static constexpr uint32_t invalidActorIndex = 0xFFFFFFFF;
+
+// What scripts hold instead of an Actor*. The slot's generation changes whenever its actor is removed,
+// so an old handle resolves to nothing and every method on it returns nil instead of touching freed memory.
+struct ActorHandle {
+    uint32_t slot = invalidActorIndex;
+    uint32_t generation = 0;
+
+    bool IsValid() const;
+    luabridge::LuaRef GetName() const;
+    luabridge::LuaRef GetID() const;
+    luabridge::LuaRef GetComponentByKey(const std::string& key) const;
+    luabridge::LuaRef GetComponent(const std::string& type) const;
+    luabridge::LuaRef GetComponents(const std::string& type) const;
+    luabridge::LuaRef AddComponent(const std::string& type) const;
+    void RemoveComponent(luabridge::LuaRef component) const;
+
+    bool operator==(const ActorHandle& other) const {
+        return slot == other.slot && generation == other.generation;
+    }
+};
 
 class Actor
 {
@@ -31,15 +54,37 @@ public:
     bool HasCollisionExitComponents();
     void SetupForDestruction();
     void ProcessDestroyedComponents();
+    void ResetToTemplate(const Actor& actorTemplate);
+    ActorHandle GetHandle() const { return { slot, generation }; }
     static void SetLuaState(lua_State* L);
 
     int id;
     std::string name;
+    std::string templateName; // Set on instantiated actors, they go back to this template's pool when destroyed
+    bool poolable = false; // Cleared when scripts add or remove components, the actor no longer matches its template
+    bool destroyed = false;
+    bool dontDestroyOnLoad = false;
+    bool componentChangesQueued = false;
+    uint32_t slot = invalidActorIndex; // See SceneManager::ResolveActor
+    uint32_t generation = 0;
+    uint32_t denseIndex = invalidActorIndex; // Position in SceneManager's actor list, invalid until the actor is added to it
     std::unordered_map<std::string, luabridge::LuaRef> components;
     std::unordered_map<std::string, std::set<std::string>> componentsByType;
-    std::map<std::string, luabridge::LuaRef> onStartComponents, onUpdateComponents, onLateUpdateComponents, onDestroyComponents;
+    std::map<std::string, luabridge::LuaRef> onDestroyComponents;
     std::map<std::string, luabridge::LuaRef> onCollisionEnterComponents, onCollisionExitComponents, onTriggerEnterComponents, onTriggerExitComponents;
     std::vector<luabridge::LuaRef> componentAddQueue;
     std::map<std::string, luabridge::LuaRef> componentsToRemove;
     static inline lua_State* luaState;
 };
+
+namespace luabridge {
+
+// Actor pointers cross into Lua as handles and come back out resolved, nullptr once the actor is gone
+template <>
+struct Stack<Actor*> {
+    static void push(lua_State* L, Actor* actor);
+    static Actor* get(lua_State* L, int index);
+    static bool isInstance(lua_State* L, int index);
+};
+
+} // namespace luabridge
@@ -0,0 +1,128 @@
+// AssetCache.h
+#pragma once
+
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "lua/lua.hpp"
+#include "LuaBridge/LuaBridge.h"
+
+
+// Compiled .scene and .template files hold the same actors as the JSON with every name, key and
+// string value interned into one table, and every override stored with its type already resolved.
+//
+// Layout, little endian:
+//   "SRLA" magic, u32 version, u32 string count, then per string: u32 length and the bytes
+//   u32 template count, then the name of every template the actors use, once each
+//   u32 actor count, then per actor:
+//     u32 template, u32 name, u32 component count, then per component:
+//       u32 key, u32 type, u32 override count, then per override:
+//         u32 member name, u8 value type, then the value: u32 string, i32, f64, u8 bool,
+//         or u32 count followed by that many i32
+// String fields are indices into the table, noAssetString when the JSON left them out.
+
+enum CompiledValueType : uint8_t {
+    COMPILED_STRING = 0,
+    COMPILED_INT,
+    COMPILED_DOUBLE,
+    COMPILED_BOOL,
+    COMPILED_INT_ARRAY
+};
+
+static constexpr uint32_t noAssetString = 0xFFFFFFFF;
+
+// Sequential reads from a compiled asset. Running past the end means the file is corrupt.
+class AssetReader {
+public:
+    AssetReader(const uint8_t* _cursor, const uint8_t* _end, const std::string* _path)
+        : cursor(_cursor), end(_end), path(_path) {}
+
+    uint32_t ReadUInt();
+    int32_t ReadInt();
+    double ReadDouble();
+    uint8_t ReadByte();
+    const uint8_t* ReadBytes(size_t size);
+    void ReadInts(std::vector<int>& out);
+    void SkipInts();
+
+    const uint8_t* GetCursor() const { return cursor; }
+    bool CanRead(size_t size) const { return static_cast<size_t>(end - cursor) >= size; }
+
+private:
+    const uint8_t* cursor;
+    const uint8_t* end;
+    const std::string* path;
+};
+
+// A compiled asset, either mapped from the cache directory or compiled into memory on this run
+class CompiledAsset {
+public:
+    CompiledAsset(const std::string& _path) : path(_path) {}
+    ~CompiledAsset();
+    CompiledAsset(const CompiledAsset&) = delete;
+    CompiledAsset& operator=(const CompiledAsset&) = delete;
+
+    bool Map(const std::string& compiledPath);
+    void Adopt(std::vector<uint8_t>&& bytes);
+    bool ReadHeader();
+
+    std::string_view GetString(uint32_t index) const;
+    const std::vector<std::string_view>& GetTemplateNames() const { return templateNames; }
+    const luabridge::LuaRef& GetLuaString(lua_State* L, uint32_t index);
+    AssetReader GetActors() const;
+
+private:
+    std::string path; // Source file, for error messages
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+    std::vector<uint8_t> ownedBytes;
+    void* mapping = nullptr; // Platform mapping handle, null when the bytes are owned
+
+    std::vector<std::string_view> strings; // Point into the asset's bytes
+    std::vector<std::string_view> templateNames;
+    std::vector<luabridge::LuaRef> luaStrings; // Created the first time each string is assigned to a component
+    size_t actorsOffset = 0;
+
+    void Unmap();
+};
+
+class AssetCache {
+public:
+    /// <summary>
+    /// Returns the compiled form of a .scene or .template file, compiling it first if the cache is missing or stale.
+    /// Prints the error and exits when the source can't be compiled.
+    /// </summary>
+    static std::shared_ptr<CompiledAsset> Load(const std::string& sourcePath);
+
+    /// <summary>
+    /// Same as Load, but throws std::runtime_error instead of exiting, for loads on a worker thread.
+    /// </summary>
+    static std::shared_ptr<CompiledAsset> TryLoad(const std::string& sourcePath);
+
+    /// <summary>
+    /// Pushes the chunk for a .lua file like luaL_loadfile does, from cached bytecode when that was compiled from the same source.
+    /// </summary>
+    static int LoadScript(lua_State* L, const std::string& sourcePath);
+
+    /// <summary>
+    /// Compiles every scene, template and component type under resources/ ahead of time.
+    /// </summary>
+    static void CompileAll();
+
+private:
+    static std::vector<uint8_t> Compile(const std::string& sourcePath);
+    static int CompileScript(lua_State* L, const std::string& sourcePath, const std::string& source);
+    static std::string GetCompiledPath(const std::string& sourcePath);
+    static void Write(const std::string& compiledPath, const std::vector<uint8_t>& bytes);
+
+    // By source path. An entry appears as soon as some thread starts loading it, and the mutex only
+    // guards the map, so a caller waits for the asset it needs instead of every compile in progress.
+    static inline std::unordered_map<std::string, std::shared_future<std::shared_ptr<CompiledAsset>>> assets;
+    static inline std::mutex assetsMutex; // Scenes are loaded on a worker thread
+    static inline std::string cacheFolderPath = "resources/.cache/";
+};
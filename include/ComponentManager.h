@@ -7,8 +7,18 @@
 #include "lua/lua.hpp"
 #include "LuaBridge/LuaBridge.h"
 #include "Rigidbody.h"
+#include "Tilemap.h"
+#include "ParticleEmitter.h"
+#include "Transform.h"
+#include "AssetCache.h"
 
 
+// Engine-side copy of a Lua component's "enabled" field. It lives in a userdata
+// referenced from the component's metatable so it is collected along with the component.
+struct ComponentState {
+    bool enabled;
+};
+
 struct CompareComponent {
     bool operator()(luabridge::LuaRef a, luabridge::LuaRef b) {
         return a["key"].tostring() < b["key"].tostring();
@@ -21,8 +31,16 @@ public:
     static void SetState(lua_State* lua_State);
     static luabridge::LuaRef LoadComponent(const std::string& componentKey, const std::string& componentName);
     static luabridge::LuaRef LoadComponentRuntime(const std::string& componentName);
+    static void PreloadComponentTypes(); // Loads every type in the component folder instead of on first use
     static void EstablishInheritance(luabridge::LuaRef instanceTable, luabridge::LuaRef parentTable);
+    static bool* GetEnabledFlag(luabridge::LuaRef component);
+    static void ResetComponent(luabridge::LuaRef component, luabridge::LuaRef templateComponent);
+    static void ReleaseNativeComponent(luabridge::LuaRef component); // Runs a native component's OnDestroy, Lua components are left alone
+    static void ApplyOverride(luabridge::LuaRef component, CompiledAsset& asset, AssetReader& reader);
     static luabridge::LuaRef CreateNewRigidbody(luabridge::LuaRef originalRigidbodyComponent, Actor* actorPtr);
+    static luabridge::LuaRef CreateNewTilemap(luabridge::LuaRef originalTilemapComponent, Actor* actorPtr);
+    static luabridge::LuaRef CreateNewParticleEmitter(luabridge::LuaRef originalEmitterComponent, Actor* actorPtr);
+    static luabridge::LuaRef CreateNewTransform(luabridge::LuaRef originalTransformComponent, Actor* actorPtr);
     static void CppLog(const std::string& message);
     static void CppLogError(const std::string& message);
 
@@ -30,10 +48,14 @@ private:
     ComponentManager();
     static bool CheckLuaState(); // Checks if luaState variable is set
     static void AddLifecycleFunctions(const std::string& componentName, luabridge::LuaRef component);
+    static luabridge::LuaRef LoadComponentType(const std::string& componentName);
 
     static inline lua_State* luaState;
     static inline std::unordered_map<std::string, luabridge::LuaRef> components;
     static inline std::vector<std::pair<luabridge::LuaRef, std::shared_ptr<Rigidbody>>> rigidbodys;
+    static inline std::vector<std::pair<luabridge::LuaRef, std::shared_ptr<Tilemap>>> tilemaps;
+    static inline std::vector<std::pair<luabridge::LuaRef, std::shared_ptr<ParticleEmitter>>> particleEmitters;
+    static inline std::vector<std::pair<luabridge::LuaRef, std::shared_ptr<Transform>>> transforms;
     static inline std::string componentFolderPath = "resources/component_types/";
     // Keeps track of the number of times a component of a certain type has been added
     static inline std::unordered_map<std::string, int> addComponentsCounter;
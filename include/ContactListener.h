@@ -1,17 +1,69 @@
 #pragma once
 
+#include <unordered_map>
+#include <vector>
 #include "box2d/box2d.h"
 #include "Actor.h"
 
 struct Collision {
-	Actor* other;
+	ActorHandle other;
 	b2Vec2 point;
 	b2Vec2 relative_velocity;
 	b2Vec2 normal;
 };
 
+enum ContactEventType : uint8_t {
+	COLLISION_ENTER = 0,
+	COLLISION_EXIT,
+	TRIGGER_ENTER,
+	TRIGGER_EXIT
+};
+
+// A contact beginning or ending, recorded during the step and handed to scripts after it
+struct ContactEvent {
+	ContactEventType type;
+	ActorHandle actorA;
+	ActorHandle actorB;
+	b2Vec2 point;
+	b2Vec2 relativeVelocity;
+	b2Vec2 normal;
+};
+
+// Box2D reports contacts per fixture pair from inside b2World::Step, while the world is locked. The listener only
+// records them, and DispatchEvents runs the Lua handlers once the step is over. Touching fixture pairs are counted
+// per actor pair, so bodies with several fixtures still get a single enter and a single exit.
 class ContactListener : public b2ContactListener
 {
+public:
+	ContactListener();
+
 	void BeginContact(b2Contact* contact) override;
 	void EndContact(b2Contact* contact) override;
+
+	/// <summary>
+	/// Calls OnCollisionEnter/Exit and OnTriggerEnter/Exit for everything recorded since the last dispatch, in order.
+	/// </summary>
+	void DispatchEvents();
+
+private:
+	struct ActorPair {
+		ActorHandle first;
+		ActorHandle second;
+		bool triggers;
+
+		bool operator==(const ActorPair& other) const {
+			return first == other.first && second == other.second && triggers == other.triggers;
+		}
+	};
+
+	struct ActorPairHash {
+		size_t operator()(const ActorPair& pair) const;
+	};
+
+	std::vector<ContactEvent> events;
+	std::vector<ContactEvent> dispatchingEvents; // Swapped with events, so contacts ending during dispatch wait for the next one
+	std::unordered_map<ActorPair, int, ActorPairHash> touchingFixturePairs;
+
+	void RecordContact(b2Contact* contact, bool begin);
+	static void CallHandlers(Actor* actor, std::map<std::string, luabridge::LuaRef>& handlers, const char* functionName, const Collision& collision);
 };
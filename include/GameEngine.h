@@ -17,15 +17,18 @@ class ContactListener;
 class GameEngine {
 public:
     GameEngine();
+    void ParseCommandLine(int argc, char* argv[]);
     void Initialize();
     void Run();
     static lua_State* GetLuaState();
     static std::shared_ptr<b2World> GetPhysicsWorld();
+    static float GetDeltaTime();
 
 private:
     bool running;
     SDL_Window* window;
     SDL_Renderer* renderer;
+    SDL_Surface* headlessSurface;
     static inline lua_State* luaState;
 
     static inline float deltaTime;
@@ -34,13 +37,28 @@ private:
     // Physics config
     static inline std::shared_ptr<b2World> world;
     std::shared_ptr<ContactListener> contactListener;
-    float timeStep = 1.0f / 60.0f;
+    static inline float timeStep = 1.0f / 60.0f;
+    int maxPhysicsSteps = 5; // Caps solver work after a slow frame, the remaining time is dropped
+    float physicsAccumulator = 0.0f;
+    bool broadPhaseDirty = true; // A scene finished loading, rebuild the broadphase trees once its OnStarts ran
+
+    // Lua garbage collection, run by the engine at the end of the frame instead of wherever allocation triggers it
+    float frameBudgetMs = 1000.0f / 60.0f;
+    int gcDeferLimitKb = 4096; // Frames over budget skip collecting until this much has been allocated
+    int gcHeapKbAfterCycle = 0;
+    bool gcCycleRunning = false; // Cycles span frames, each frame's steps pick up where the last ones stopped
+    double lastRenderMs = 0.0; // Reserved from the budget, rendering comes after collection
 
     // Config variables
     std::string windowTitle = "";
     int windowWidth = 640, windowHeight = 360;
     int clearColorR = 255, clearColorG = 255, clearColorB = 255;     
 
+    // Benchmark config (set from the command line)
+    bool headless = false;
+    int frameLimit = 0; // 0 runs until the game quits
+    float fixedDeltaTime = 0.0f; // 0 uses the measured frame time
+
     void LoadResources();
     void InitializeLua();
     void InitializeB2D();
@@ -48,6 +66,8 @@ private:
     void Update();
     void Render();
     void StepPhysics();
+    void SyncPhysicsTransforms();
+    void CollectLuaGarbage();
 
     // Application Scripting API
     static void ApplicationQuit();
@@ -6,16 +6,17 @@
 #include <unordered_map>
 #include <vector>
 #include <queue>
+#include "lua/lua.hpp"
 
 
 struct ScreenSpaceDrawRequest {
-	ScreenSpaceDrawRequest(const std::string& _imageName, float _x, float _y, float _rotationDegrees, float _scaleX, float _scaleY, float _pivotX, float _pivotY, float _r, float _g, float _b, float _a, float _sortingOrder)
-		: imageName(_imageName), x(_x), y(_y), scaleX(_scaleX), scaleY(_scaleY), pivotX(_pivotX), pivotY(_pivotY), rotationDegrees(static_cast<int>(_rotationDegrees)), r(static_cast<int>(_r)), g(static_cast<int>(_g)), b(static_cast<int>(_b)), a(static_cast<int>(_a)), sortingOrder(static_cast<int>(_sortingOrder)) {}
+	ScreenSpaceDrawRequest(int _image, float _x, float _y, float _rotationDegrees, float _scaleX, float _scaleY, float _pivotX, float _pivotY, float _r, float _g, float _b, float _a, float _sortingOrder)
+		: image(_image), x(_x), y(_y), scaleX(_scaleX), scaleY(_scaleY), pivotX(_pivotX), pivotY(_pivotY), rotationDegrees(static_cast<int>(_rotationDegrees)), r(static_cast<int>(_r)), g(static_cast<int>(_g)), b(static_cast<int>(_b)), a(static_cast<int>(_a)), sortingOrder(static_cast<int>(_sortingOrder)) {}
 
-	ScreenSpaceDrawRequest(const std::string& _imageName, float _x, float _y)
-		: imageName(_imageName), x(_x), y(_y), scaleX(1), scaleY(1), pivotX(0.5), pivotY(0.5), rotationDegrees(0), r(255), g(255), b(255), a(255), sortingOrder(0) {}
+	ScreenSpaceDrawRequest(int _image, float _x, float _y)
+		: image(_image), x(_x), y(_y), scaleX(1), scaleY(1), pivotX(0.5), pivotY(0.5), rotationDegrees(0), r(255), g(255), b(255), a(255), sortingOrder(0) {}
 
-	std::string imageName;
+	int image; // Handle from ImageManager::LoadImageHandle
 	float x;
 	float y;
 	float scaleX;
@@ -30,6 +31,12 @@ struct ScreenSpaceDrawRequest {
 	int sortingOrder;
 };
 
+struct LoadedImage {
+	SDL_Texture* texture;
+	float width;
+	float height;
+};
+
 struct PixelDrawRequest {
 	PixelDrawRequest(float _x, float _y, float _r, float _g, float _b, float _a)
 		: x(static_cast<int>(_x)), y(static_cast<int>(_y)), r(static_cast<int>(_r)), g(static_cast<int>(_g)), b(static_cast<int>(_b)), a(static_cast<int>(_a)) {}
@@ -42,30 +49,60 @@ struct PixelDrawRequest {
 	int a;
 };
 
+// World-space sprite counts for the last rendered frame
+struct DrawStats {
+	int submitted = 0;
+	int culled = 0; // Entirely outside the camera view, never sorted or sent to SDL
+	int drawn = 0;
+};
+
 class ImageManager {
 public:
     static void Initialize(SDL_Renderer* _renderer);
 
-	static void SubmitUIDrawRequest(const std::string& imageName, float x, float y);
-	static void SubmitUIExDrawRequest(const std::string& imageName, float x, float y, float r, float g, float b, float a, float sortingOrder, float rotationDegrees = 0.0f, float scaleX = 1.0f, float scaleY = 1.0f, float pivotX = 0.5f, float pivotY = 0.5f);
-	static void SubmitScreenSpaceDrawRequest(const std::string& imageName, float x, float y);
-	static void SubmitScreenSpaceExDrawRequest(const std::string& imageName, float x, float y, float rotationDegrees, float scaleX, float scaleY, float pivotX, float pivotY, float r, float g, float b, float a, float sortingOrder);
+	static int LoadImageHandle(const std::string& imageName);
+	static int CreateTargetImage(int width, int height);
+	static void DestroyImage(int image);
+	static const LoadedImage& GetImage(int image);
+	static SDL_Renderer* GetRenderer();
+
+	static void SubmitUIDrawRequest(int image, float x, float y);
+	static void SubmitUIExDrawRequest(int image, float x, float y, float r, float g, float b, float a, float sortingOrder, float rotationDegrees = 0.0f, float scaleX = 1.0f, float scaleY = 1.0f, float pivotX = 0.5f, float pivotY = 0.5f);
+	static void SubmitScreenSpaceDrawRequest(int image, float x, float y);
+	static void SubmitScreenSpaceExDrawRequest(int image, float x, float y, float rotationDegrees, float scaleX, float scaleY, float pivotX, float pivotY, float r, float g, float b, float a, float sortingOrder);
 	static void SubmitPixelDrawRequest(float x, float y, float r, float g, float b, float a);
 
+	// Lua entry points. The image argument may be a name or a handle from Image.Load
+	static int LuaLoad(lua_State* L);
+	static int LuaDrawUI(lua_State* L);
+	static int LuaDrawUIEx(lua_State* L);
+	static int LuaDraw(lua_State* L);
+	static int LuaDrawEx(lua_State* L);
+	static int LuaGetDrawStats(lua_State* L);
+
 	static void DrawUIRequestQueue();
 	static void DrawScreenSpaceRequestQueue();
 	static void DrawPixelRequestQueue();
 
 private:
     ImageManager();
-	static SDL_Texture* LoadImage(const std::string& imageName);
-	static SDL_RendererFlip GetRendererFlip(bool horizontalFlip, bool verticalFlip);
-	static void DrawScreenSpace(SDL_Texture* texture, const ScreenSpaceDrawRequest& request, bool moveWithCamera = true);
+	static int GetImageArgument(lua_State* L, int index);
+	static bool IsVisible(const ScreenSpaceDrawRequest& request, float viewWidth, float viewHeight);
+	static void DrawSpriteBatch(std::vector<ScreenSpaceDrawRequest>& requestQueue, bool moveWithCamera);
+	static void AppendSprite(const ScreenSpaceDrawRequest& request, bool moveWithCamera);
+	static void FlushSprites(SDL_Texture* texture);
 
     static inline SDL_Renderer* renderer; // SDL_Renderer reference
-    static inline std::unordered_map<std::string, SDL_Texture*> textures; // Map to store textures
+    static inline std::vector<LoadedImage> images; // Indexed by image handle
+    static inline std::unordered_map<std::string, int> imageHandles; // Image name to handle
+    static inline std::vector<int> freeImageHandles; // Released by DestroyImage, reused by CreateTargetImage
     static inline std::string imageFolderPath = "resources/images/";
 	static inline std::vector<ScreenSpaceDrawRequest> UIRequestQueue;
 	static inline std::vector<ScreenSpaceDrawRequest> screenSpaceRequestQueue;
 	static inline std::vector<PixelDrawRequest> pixelRequestQueue;
+	static inline DrawStats drawStats;
+
+	// Scratch buffers reused every frame by the sprite batcher
+	static inline std::vector<SDL_Vertex> batchVertices;
+	static inline std::vector<int> batchIndices;
 };
\ No newline at end of file
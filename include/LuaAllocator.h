@@ -0,0 +1,51 @@
+// LuaAllocator.h
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct LuaAllocatorStats {
+    uint64_t allocations = 0;
+    uint64_t liveBlocks = 0;
+    uint64_t peakLiveBlocks = 0;
+};
+
+// Allocation function for the Lua state. Tables, strings, closures and the other small objects Lua makes all the time
+// are served from per size class free lists carved out of large chunks, the same scheme as b2BlockAllocator.
+// Lua always passes the old size back in, so blocks need no header. Larger blocks go to malloc.
+class LuaAllocator {
+public:
+    /// <summary>
+    /// lua_Alloc for lua_newstate. Frees when newSize is 0, allocates when block is null, reallocates otherwise.
+    /// </summary>
+    static void* Allocate(void* userData, void* block, size_t oldSize, size_t newSize);
+
+    /// <summary>
+    /// Prints allocation counts and bytes per size class.
+    /// </summary>
+    static void PrintReport();
+
+private:
+    LuaAllocator();
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    static constexpr size_t chunkSize = 16 * 1024;
+    static constexpr size_t maxBlockSize = 512;
+    static constexpr int sizeClassCount = 20; // 16 byte steps up to 256, then 64 byte steps up to maxBlockSize
+
+    static int GetSizeClass(size_t size);
+    static size_t GetBlockSize(int sizeClass);
+    static void* AllocateBlock(int sizeClass);
+    static void FreeBlockToList(void* block, int sizeClass);
+
+    static inline FreeBlock* freeLists[sizeClassCount] = {};
+    static inline std::vector<void*> chunks; // Never released, like b2BlockAllocator the pools only grow
+
+    static inline LuaAllocatorStats sizeClassStats[sizeClassCount];
+    static inline LuaAllocatorStats largeStats;
+    static inline uint64_t largeLiveBytes = 0;
+};
@@ -0,0 +1,63 @@
+// ParticleEmitter.h
+#pragma once
+
+class Actor;
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <random>
+
+
+// Native particle component. Particles are plain floats in parallel arrays, so the per-frame update
+// is a handful of straight loops (four particles per SSE instruction where available) instead of a
+// Lua actor per particle.
+class ParticleEmitter
+{
+public:
+    std::string image = ""; // Image in resources/images drawn for every particle
+    float x = 0.0f, y = 0.0f; // World position particles spawn at
+    float emitRate = 10.0f; // Particles per second
+    int maxParticles = 1000;
+    float lifetime = 1.0f; // Seconds
+    float lifetimeVariance = 0.0f; // Each particle lives lifetime +/- up to this many seconds
+    float speedMin = 1.0f, speedMax = 2.0f; // World units per second
+    float angleMin = 0.0f, angleMax = 360.0f; // Degrees clockwise from the right
+    float gravityX = 0.0f, gravityY = 0.0f;
+    float drag = 0.0f; // Fraction of velocity lost per second
+    float startScale = 1.0f, endScale = 1.0f;
+    float startColorR = 255.0f, startColorG = 255.0f, startColorB = 255.0f, startColorA = 255.0f;
+    float endColorR = 255.0f, endColorG = 255.0f, endColorB = 255.0f, endColorA = 0.0f;
+    int sortingOrder = 0;
+
+    std::string type = "ParticleEmitter";
+    std::string key;
+    bool enabled = true;
+    Actor* actor;
+
+    void Burst(int count);
+    void Clear();
+    int GetParticleCount();
+
+    void OnStart();
+    void OnUpdate();
+
+    std::shared_ptr<ParticleEmitter> Clone(Actor* actor) const;
+
+private:
+    // One entry per live particle in every array
+    std::vector<float> positionX, positionY;
+    std::vector<float> velocityX, velocityY;
+    std::vector<float> age, lifetimes;
+
+    int imageHandle = -1;
+    float emitAccumulator = 0.0f;
+    std::mt19937 random;
+
+    void Emit(int count);
+    void Simulate(float deltaTime);
+    void RemoveExpired();
+    void Draw();
+
+    static inline unsigned int nextSeed = 1; // Every emitter gets its own stream, same sequence every run
+};
@@ -0,0 +1,74 @@
+// Profiler.h
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+enum ProfilePhase {
+    PROFILE_PROCESS_INPUT = 0,
+    PROFILE_LOAD_SCENE,
+    PROFILE_ON_START,
+    PROFILE_ON_UPDATE,
+    PROFILE_ON_LATE_UPDATE,
+    PROFILE_ON_DESTROY,
+    PROFILE_UPDATE_COMPONENTS,
+    PROFILE_PROCESS_ACTOR_QUEUES,
+    PROFILE_EVENT_BUS,
+    PROFILE_STEP_PHYSICS,
+    PROFILE_TRANSFORMS,
+    PROFILE_LUA_GC,
+    PROFILE_RENDER,
+    PROFILE_PHASE_COUNT
+};
+
+struct PhaseStats {
+    double totalMs = 0.0;
+    double minMs = 0.0;
+    double maxMs = 0.0;
+};
+
+// Collects per-phase frame timings for headless benchmark runs.
+// When disabled every call is a single branch, so the scopes can stay in the frame loop.
+class Profiler {
+public:
+    static void SetEnabled(bool enable);
+    static bool IsEnabled();
+
+    static void BeginFrame();
+    static void EndFrame();
+    static void AddPhaseTime(ProfilePhase phase, double ms);
+    static void SetLuaHeapKb(double kb);
+    static void PrintReport();
+
+private:
+    Profiler();
+
+    static inline bool enabled = false;
+    static inline uint64_t frameCount = 0;
+    static inline std::chrono::high_resolution_clock::time_point frameStart;
+    static inline std::chrono::high_resolution_clock::time_point runStart;
+    static inline double frameMs[PROFILE_PHASE_COUNT];
+    static inline PhaseStats phaseStats[PROFILE_PHASE_COUNT];
+    static inline PhaseStats frameStats;
+    static inline double frameLuaHeapKb = 0.0;
+    static inline PhaseStats luaHeapStats; // In KB rather than ms
+};
+
+// Times the enclosing block and adds it to the given phase for the current frame
+struct ProfileScope {
+    ProfileScope(ProfilePhase _phase) : phase(_phase) {
+        if (Profiler::IsEnabled())
+            start = std::chrono::high_resolution_clock::now();
+    }
+
+    ~ProfileScope() {
+        if (!Profiler::IsEnabled())
+            return;
+        auto end = std::chrono::high_resolution_clock::now();
+        Profiler::AddPhaseTime(phase, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    ProfilePhase phase;
+    std::chrono::high_resolution_clock::time_point start;
+};
@@ -6,6 +6,8 @@ class Actor;
 #include <memory>
 #include "box2d/box2d.h"
 #include "glm/glm.hpp"
+#include "lua/lua.hpp"
+#include "Transform.h"
 
 
 enum Category {
@@ -45,6 +47,13 @@ public:
     bool enabled = true;
     Actor* actor;
 
+    // Body transform before the most recent fixed step, blended with the current one for rendering
+    b2Vec2 previousPosition = b2Vec2(0.0f, 0.0f);
+    float previousAngle = 0.0f;
+
+    // The actor's Transform when it has one, written by GameEngine::SyncPhysicsTransforms after every physics update
+    Transform* transform = nullptr;
+
     void AddForce(b2Vec2 force) {
         body->ApplyForceToCenter(force, true);
     }
@@ -70,6 +79,7 @@ public:
             return;
         }
         body->SetTransform(position, body->GetAngle());
+        previousPosition = position; // Teleports should not be interpolated
     }
 
     b2Vec2 GetPosition() {
@@ -87,6 +97,7 @@ public:
         }
         float radians = degreesClockwise * (b2_pi / 180.0f);
         body->SetTransform(body->GetPosition(), radians);
+        previousAngle = radians;
     }
 
     float GetRotation() {
@@ -98,6 +109,25 @@ public:
         return degrees;
     }
 
+    // Position blended between the last two fixed steps, use this for anything drawn every frame
+    b2Vec2 GetInterpolatedPosition() {
+        if (body == nullptr) {
+            return b2Vec2(x, y);
+        }
+
+        const b2Vec2& current = body->GetPosition();
+        return previousPosition + interpolationAlpha * (current - previousPosition);
+    }
+
+    float GetInterpolatedRotation() {
+        if (body == nullptr) {
+            return rotationDegrees;
+        }
+
+        float radians = previousAngle + interpolationAlpha * (body->GetAngle() - previousAngle);
+        return radians * (180.0f / b2_pi);
+    }
+
     void SetAngularVelocity(float degreesClockwise) {
         if (body == nullptr) {
             return;
@@ -167,12 +197,39 @@ public:
         return b2Vec2(glm::cos(angle), glm::sin(angle));
     }
 
+    // Versions of the vector getters and setters that take and return plain numbers. Lua gets two values
+    // back instead of a new Vector2 userdata, so per frame movement code leaves nothing for the collector.
+    int GetPositionXY(lua_State* L) {
+        return PushXY(L, GetPosition());
+    }
+
+    int GetInterpolatedPositionXY(lua_State* L) {
+        return PushXY(L, GetInterpolatedPosition());
+    }
+
+    int GetVelocityXY(lua_State* L) {
+        return PushXY(L, GetVelocity());
+    }
+
+    void SetPositionXY(float positionX, float positionY) {
+        SetPosition(b2Vec2(positionX, positionY));
+    }
+
+    void SetVelocityXY(float velocityX, float velocityY) {
+        SetVelocity(b2Vec2(velocityX, velocityY));
+    }
+
+    void AddForceXY(float forceX, float forceY) {
+        AddForce(b2Vec2(forceX, forceY));
+    }
+
     void OnStart() {
         bodyDef.position.Set(x, y);
         bodyDef.bullet = precise;
         bodyDef.gravityScale = gravityScale;
         bodyDef.angularDamping = angularFriction;
         bodyDef.angle = rotationDegrees * (b2_pi / 180.0f);
+        bodyDef.userData.pointer = reinterpret_cast<uintptr_t>(this);
 
         if (bodyTypeString == "dynamic") {
             bodyDef.type = b2_dynamicBody;
@@ -185,6 +242,9 @@ public:
         }
 
         body = world->CreateBody(&bodyDef);
+        previousPosition = bodyDef.position;
+        previousAngle = bodyDef.angle;
+        transform = Transform::GetActorTransform(actor);
 
         // Handle Collider
         if (hasCollider) {
@@ -255,7 +315,11 @@ public:
 
 
     void OnDestroy() {
+        if (body == nullptr)
+            return;
+
         world->DestroyBody(body);
+        body = nullptr;
     }
 
     std::shared_ptr<Rigidbody> Clone(Actor* actor) const {
@@ -302,6 +366,29 @@ public:
         world = w;
     }
 
+    // Snapshot every body's transform so the next step can be interpolated against it
+    static void SavePreviousTransforms() {
+        for (b2Body* b = world->GetBodyList(); b != nullptr; b = b->GetNext()) {
+            Rigidbody* rb = reinterpret_cast<Rigidbody*>(b->GetUserData().pointer);
+            if (rb == nullptr)
+                continue;
+
+            rb->previousPosition = b->GetPosition();
+            rb->previousAngle = b->GetAngle();
+        }
+    }
+
+    static void SetInterpolationAlpha(float alpha) {
+        interpolationAlpha = alpha;
+    }
+
 private:
     static inline std::shared_ptr<b2World> world;
+    static inline float interpolationAlpha = 1.0f;
+
+    static int PushXY(lua_State* L, const b2Vec2& vector) {
+        lua_pushnumber(L, vector.x);
+        lua_pushnumber(L, vector.y);
+        return 2;
+    }
 };
@@ -7,17 +7,58 @@
 #include <map>
 #include <vector>
 #include <memory>
+#include <chrono>
+#include <future>
+#include <optional>
 #include "TemplateManager.h"
-#include "ReadJsonFile.h"
+#include "AssetCache.h"
 #include "lua/lua.hpp"
 #include "LuaBridge/LuaBridge.h"
 
 enum LifecycleFunctionType { OnStart = 0, OnUpdate = 1, OnLateUpdate = 2 };
+static constexpr int numLifecycleFunctionTypes = 3;
+
+// A component that implements one lifecycle function. The function and enabled flag are resolved
+// once when the component is registered so the per-frame passes never index Lua tables.
+struct LifecycleEntry {
+    LifecycleEntry(Actor* _actor, const std::string& _key, const void* _identity, const bool* _enabled, luabridge::LuaRef _component, luabridge::LuaRef _function)
+        : actor(_actor), key(_key), identity(_identity), enabled(_enabled), component(_component), function(_function) {}
+
+    Actor* actor;
+    std::string key;
+    const void* identity; // The component's address in Lua, used to match removals
+    const bool* enabled;
+    luabridge::LuaRef component;
+    luabridge::LuaRef function;
+};
+
+// Component types that define a static OnUpdateBatch(instances) are updated with one call per frame
+// that receives every enabled instance, instead of one OnUpdate call per instance.
+struct LifecycleBatch {
+    LifecycleBatch(luabridge::LuaRef _function, luabridge::LuaRef _instances)
+        : function(_function), instances(_instances) {}
+
+    luabridge::LuaRef function;
+    luabridge::LuaRef instances; // Refilled and passed to the function every frame
+    std::vector<LifecycleEntry> entries;
+    size_t sortedCount = 0; // Entries past this were added since the last sort
+};
+
+// One entry per actor handle slot. Freed slots are reused with the next generation.
+struct ActorSlot {
+    Actor* actor = nullptr;
+    uint32_t generation = 0;
+};
 
 class SceneManager
 {
 public:
     static void LoadScene(const std::string& sceneName);
+    static void LoadSceneAsync(const std::string& sceneName);
+    static void ContinueSceneLoad();
+    static bool IsLoading();
+    static float GetLoadProgress();
+    static void SetLoadBudget(float milliseconds);
     static void RunOnStartLifecycleFunctions();
     static void RunOnUpdateLifecycleFunctions();
     static void RunOnLateUpdateLifecycleFunctions();
@@ -32,18 +73,51 @@ public:
     static std::string GetCurrentSceneName();
     static void DontDestroy(Actor* actor);
     static void SetLuaState(lua_State* state);
+    static void AddComponentLifecycle(Actor* actor, const std::string& key, luabridge::LuaRef component, LifecycleFunctionType type, luabridge::LuaRef function);
+    static void AddComponentUpdateBatch(Actor* actor, const std::string& key, luabridge::LuaRef component, const std::string& type, luabridge::LuaRef function);
+    static void RemoveComponentLifecycle(luabridge::LuaRef component);
+    static void QueueComponentChanges(Actor* actor);
+    static Actor* ResolveActor(const ActorHandle& handle);
     static inline bool loadingNewScene = false;
     static inline std::string nextSceneName;
 
 private:
     static inline std::string sceneName;
     static inline uint32_t totalActors = 0;
-    static inline std::vector<std::shared_ptr<Actor>> actorVector;
-    static inline std::vector<std::shared_ptr<Actor>> dontDestroyOnLoadActors;
+    static inline std::vector<std::shared_ptr<Actor>> actorVector; // Unordered, removal swaps with the last actor
     static inline std::unordered_map<std::string, std::vector<std::shared_ptr<Actor>>> actorMap;
     static inline std::vector<std::shared_ptr<Actor>> actorsToAdd;
     static inline std::unordered_set<Actor*> actorsToRemove;
-    static void ParseScene(const rapidjson::Document& sceneDoc);
+    static inline std::unordered_map<std::string, std::vector<std::shared_ptr<Actor>>> actorPools; // Destroyed actors by template name
+    static inline std::vector<std::shared_ptr<Actor>> actorsToPool; // Scratch for ProcessActorQueues
+    static inline std::vector<std::vector<std::shared_ptr<Actor>>*> actorListsToCompact; // Scratch for ProcessActorQueues
+    static inline std::vector<ActorSlot> actorSlots;
+    static inline std::vector<uint32_t> freeActorSlots;
+    static inline std::vector<ActorHandle> actorsWithComponentChanges; // Actors with components queued for adding or removal
+    static void AllocateActorSlot(Actor* actor);
+    static void ReleaseActorSlot(Actor* actor);
+    static void BeginSceneBuild(const std::string& name, std::shared_ptr<CompiledAsset> sceneAsset);
+    static void BuildSceneActors(float budgetSeconds);
     static bool IsActorFlaggedForRemoval(Actor* actor);
+    static void RunLifecycleFunctions(LifecycleFunctionType type, const char* functionName);
+    static void RunUpdateBatches();
+    static void FlushRemovedLifecycleEntries();
+
+    // Every registered lifecycle function in the game, per type, ordered by actor id and then component key
+    static inline std::vector<LifecycleEntry> lifecycleEntries[numLifecycleFunctionTypes];
+    static inline size_t lifecycleEntriesSorted[numLifecycleFunctionTypes] = {}; // Entries past this were added since the last sort
+    static inline std::map<std::string, LifecycleBatch> updateBatches; // By component type
+    static inline std::unordered_set<const void*> removedLifecycleComponents;
+    static inline std::unordered_set<Actor*> removedLifecycleActors;
     static inline lua_State* luaState;
+
+    // Scene loading, see LoadSceneAsync
+    static inline std::future<std::shared_ptr<CompiledAsset>> pendingScene;
+    static inline std::string pendingSceneName;
+    static inline std::shared_ptr<CompiledAsset> sceneBuildAsset; // Set while actors are still being built
+    static inline std::optional<AssetReader> sceneBuildReader;
+    static inline uint32_t sceneBuildTotal = 0;
+    static inline uint32_t sceneBuildCount = 0;
+    static inline float sceneLoadBudget = 0.004f; // Seconds of actor building and OnStart per frame
+    static inline float lastOnStartSeconds = 0.0f;
 };
@@ -6,8 +6,8 @@
 #include <filesystem>
 #include <iostream>
 #include "rapidjson/document.h"
-#include "ReadJsonFile.h"
 #include "Actor.h"
+#include "AssetCache.h"
 #include <memory>
 #include "lua/lua.hpp"
 #include "LuaBridge/LuaBridge.h"
@@ -20,8 +20,9 @@ public:
     /// </summary>
     /// <returns></returns>
     static std::shared_ptr<Actor> LoadTemplate(const std::string& templateName);
+    static std::string GetTemplatePath(const std::string& templateName);
 
 private:
     static inline std::unordered_map<std::string, std::shared_ptr<Actor>> templateMap;
-    static std::shared_ptr<Actor> ParseTemplate(const rapidjson::Document& templateDocument);
+    static std::shared_ptr<Actor> ParseTemplate(CompiledAsset& templateAsset);
 };
\ No newline at end of file
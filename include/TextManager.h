@@ -3,9 +3,12 @@
 
 #include "SDL2/SDL.h"
 #include "SDL_ttf/SDL_ttf.h"
+#include <cstdint>
+#include <list>
 #include <string>
 #include <unordered_map>
 #include <queue>
+#include <vector>
 
 struct TextDrawRequest {
 	TextDrawRequest(const std::string& _content, float _x, float _y, const std::string& _fontName, float _fontSize, float _r, float _g, float _b, float _a)
@@ -22,6 +25,34 @@ struct TextDrawRequest {
 	int a;
 };
 
+// Printable ASCII is baked into a per-font atlas, anything else goes through the string cache
+static constexpr int firstAtlasGlyph = 32;
+static constexpr int lastAtlasGlyph = 126;
+static constexpr int atlasGlyphCount = lastAtlasGlyph - firstAtlasGlyph + 1;
+
+struct GlyphInfo {
+	float u0, v0, u1, v1; // Texture coordinates in the atlas
+	int width;
+	int height;
+	int offsetX; // Left edge of the glyph image relative to the pen position
+	int advance;
+};
+
+// Every atlas glyph of one font at one size, packed into a single texture
+struct GlyphAtlas {
+	SDL_Texture* texture = nullptr;
+	int lineHeight = 0;
+	GlyphInfo glyphs[atlasGlyphCount];
+};
+
+// A whole string rendered to its own texture, for labels that are drawn frame after frame
+struct CachedText {
+	SDL_Texture* texture = nullptr;
+	int width = 0;
+	int height = 0;
+	std::list<std::string>::iterator lruPosition;
+};
+
 class TextManager
 {
 public:
@@ -34,8 +65,32 @@ private:
 	static inline std::queue<TextDrawRequest> textDrawRequestQueue;
 	static inline SDL_Renderer* renderer;
 
+	static inline std::unordered_map<TTF_Font*, GlyphAtlas> atlases;
+	static inline std::unordered_map<std::string, CachedText> textCache;
+	static inline std::list<std::string> textCacheLru; // Most recently drawn first
+	static inline std::string textCacheKey; // Reused for every lookup so finding a string doesn't allocate
+	static constexpr size_t textCacheCapacity = 256;
+	static constexpr int textCachePromoteCount = 3;
+
+	// Times each atlas string was drawn, by hash, so text that changes every frame never reaches the cache.
+	// A slot only remembers the last string that hashed to it, a collision just delays caching.
+	static constexpr size_t textDrawCountSlots = 1024;
+	static inline uint64_t textDrawHashes[textDrawCountSlots] = {};
+	static inline int textDrawCounts[textDrawCountSlots] = {};
+
+	// Quads waiting to be submitted with the same texture
+	static inline SDL_Texture* batchTexture = nullptr;
+	static inline std::vector<SDL_Vertex> batchVertices;
+	static inline std::vector<int> batchIndices;
+
 	TextManager();
 	static TTF_Font* LoadFont(const std::string& fontName, int fontSize);
+	static GlyphAtlas& LoadAtlas(TTF_Font* font);
+	static int CountTextDraw(const TextDrawRequest& request);
+	static CachedText& TouchCachedText(const TextDrawRequest& request);
+	static void RenderCachedText(CachedText& cachedText, TTF_Font* font, const std::string& content);
 	static void DrawText(const TextDrawRequest& request);
+	static void AppendQuad(SDL_Texture* texture, float x, float y, float width, float height, float u0, float v0, float u1, float v1, SDL_Color color);
+	static void FlushQuads();
 };
 
@@ -0,0 +1,68 @@
+// Tilemap.h
+#pragma once
+
+class Actor;
+
+#include <string>
+#include <vector>
+#include <memory>
+#include "box2d/box2d.h"
+
+
+// A square block of tiles baked into one render target texture. Only chunks with at least one tile get a texture.
+struct TilemapChunk {
+    int image = -1; // Handle from ImageManager::CreateTargetImage, -1 while the chunk is empty
+    float x = 0.0f, y = 0.0f; // World position of the chunk's top left corner
+    b2Body* body = nullptr; // Static body holding the chunk's merged colliders
+};
+
+// Native component for static tile layers. The layer is baked into chunk textures once in OnStart,
+// so a frame costs one draw request per chunk instead of one per tile, and solid tiles become one
+// chain loop per outline instead of a Rigidbody per tile.
+class Tilemap
+{
+public:
+    std::string tileset = ""; // Image in resources/images, tiles are numbered from 1 left to right, top to bottom
+    int tileWidth = 32; // Pixels
+    int tileHeight = 32;
+    int columns = 0; // Layer size in tiles
+    int rows = 0;
+    int chunkSize = 32; // Tiles per chunk side
+    float x = 0.0f, y = 0.0f; // World position of the layer's top left corner
+    int sortingOrder = 0;
+    bool hasCollider = false;
+    float friction = 0.3f;
+    float bounciness = 0.0f;
+
+    // Row-major tile numbers from the scene or template, 0 is empty
+    std::vector<int> tiles;
+
+    std::string type = "Tilemap";
+    std::string key;
+    bool enabled = true;
+    Actor* actor;
+
+    int GetTile(int column, int row);
+    int GetChunkCount();
+
+    void OnStart();
+    void OnUpdate();
+    void OnDestroy();
+
+    std::shared_ptr<Tilemap> Clone(Actor* actor) const;
+
+    static void SetWorld(std::shared_ptr<b2World> w) {
+        world = w;
+    }
+
+private:
+    std::vector<TilemapChunk> chunks;
+    int chunkColumns = 0;
+    int chunkRows = 0;
+
+    void BakeChunk(TilemapChunk& chunk, int firstColumn, int firstRow, int tilesetImage);
+    void BuildChunkColliders(TilemapChunk& chunk, int firstColumn, int firstRow);
+    bool IsSolid(int column, int row, int firstColumn, int firstRow);
+
+    static inline std::shared_ptr<b2World> world;
+};
@@ -0,0 +1,88 @@
+// Transform.h
+#pragma once
+
+class Actor;
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include "box2d/box2d.h"
+
+static constexpr uint32_t invalidTransformSlot = 0xFFFFFFFF;
+
+// Native position, rotation and scale. The values live in static parallel arrays instead of in the
+// component, so the once per frame hierarchy pass (and anything else that wants every transform)
+// walks contiguous floats. A Transform object is only a slot in those arrays.
+class Transform
+{
+public:
+    Transform();
+    Transform(const Transform& other); // Takes a slot of its own, two transforms never share one
+    Transform& operator=(const Transform& other); // Copies the values into this transform's own slot, or keeps them for Reattach when it has none
+
+    std::string type = "Transform";
+    std::string key;
+    bool enabled = true;
+    Actor* actor;
+
+    // Local values, relative to the parent when there is one. Rotation is in degrees clockwise.
+    float GetX() const;
+    void SetX(float value);
+    float GetY() const;
+    void SetY(float value);
+    float GetRotation() const;
+    void SetRotation(float degreesClockwise);
+    float GetScaleX() const;
+    void SetScaleX(float value);
+    float GetScaleY() const;
+    void SetScaleY(float value);
+    b2Vec2 GetPosition() const;
+    void SetPosition(b2Vec2 position);
+
+    // World values as of the last UpdateWorldTransforms, which runs once per frame after physics
+    b2Vec2 GetWorldPosition() const;
+    float GetWorldRotation() const;
+    b2Vec2 GetWorldScale() const;
+
+    // Sets the local position and rotation that put this transform at the given world pose, through the parent's
+    // world values as of the last UpdateWorldTransforms
+    void SetWorldPose(b2Vec2 position, float degreesClockwise);
+
+    void SetParent(Transform* parent); // nil makes this a root again
+    Transform* GetParent() const;
+
+    void OnDestroy();
+    void Reattach(); // Gives a pooled transform a slot again, holding the values it was last reset to
+
+    std::shared_ptr<Transform> Clone(Actor* actor) const;
+
+    /// <summary>
+    /// Recomputes every world value from the local values, parents before children, in one pass.
+    /// </summary>
+    static void UpdateWorldTransforms();
+
+    static Transform* GetActorTransform(Actor* actor); // nullptr when the actor has no Transform
+
+private:
+    uint32_t slot = invalidTransformSlot; // Invalid once destroyed, reads then return defaults and writes are ignored
+
+    // Template values assigned while the transform had no slot, so a pooled actor holds none until it is reused
+    float resetX = 0.0f, resetY = 0.0f, resetRotation = 0.0f, resetScaleX = 1.0f, resetScaleY = 1.0f;
+
+    static uint32_t AllocateSlot();
+    static void RebuildUpdateOrder();
+    static bool IsAncestor(uint32_t ancestor, uint32_t descendant);
+
+    static inline std::vector<float> localX, localY, localRotation, localScaleX, localScaleY;
+    static inline std::vector<float> worldX, worldY, worldRotation, worldScaleX, worldScaleY;
+    static inline std::vector<uint32_t> parents; // Parent slot, invalidTransformSlot for roots
+    static inline std::vector<Transform*> owners; // nullptr for free slots
+    static inline std::vector<uint32_t> freeSlots;
+    static inline std::vector<uint32_t> releasedSlots; // Freed once their children have been detached
+
+    // Live slots ordered by depth, so every parent is updated before its children
+    static inline std::vector<uint32_t> updateOrder;
+    static inline std::vector<uint32_t> depths; // Scratch for RebuildUpdateOrder
+    static inline bool updateOrderDirty = false;
+};
@@ -37,13 +37,17 @@ struct B2_API b2Pair
 /// The broad-phase is used for computing pairs and performing volume queries and ray casts.
 /// This broad-phase does not persist pairs. Instead, this reports potentially new pairs.
 /// It is up to the client to consume the new pairs and to track subsequent overlap.
+/// Static proxies live in a tree of their own. They never pair with each other, so only
+/// moving proxies query the static tree, and the static tree can be built once for quality
+/// instead of being rebalanced as the level changes.
 class B2_API b2BroadPhase
 {
 public:
 
 	enum
 	{
-		e_nullProxy = -1
+		e_nullProxy = -1,
+		e_staticProxyFlag = 0x40000000
 	};
 
 	b2BroadPhase();
@@ -51,7 +55,8 @@ public:
 
 	/// Create a proxy with an initial AABB. Pairs are not reported until
 	/// UpdatePairs is called.
-	int32 CreateProxy(const b2AABB& aabb, void* userData);
+	/// @param staticProxy put the proxy in the static tree. Use for proxies that rarely move.
+	int32 CreateProxy(const b2AABB& aabb, void* userData, bool staticProxy = false);
 
 	/// Destroy a proxy. It is up to the client to remove any pairs.
 	void DestroyProxy(int32 proxyId);
@@ -94,15 +99,20 @@ public:
 	template <typename T>
 	void RayCast(T* callback, const b2RayCastInput& input) const;
 
-	/// Get the height of the embedded tree.
+	/// Get the height of the taller embedded tree.
 	int32 GetTreeHeight() const;
 
-	/// Get the balance of the embedded tree.
+	/// Get the balance of the less balanced embedded tree.
 	int32 GetTreeBalance() const;
 
-	/// Get the quality metric of the embedded tree.
+	/// Get the quality metric of the dynamic tree.
 	float GetTreeQuality() const;
 
+	/// Rebuild both trees top-down for the best query performance. Call once the
+	/// bodies of a level are created. The static tree is never restructured otherwise,
+	/// the dynamic tree goes back to incremental updates as proxies move.
+	void RebuildTrees();
+
 	/// Shift the world origin. Useful for large worlds.
 	/// The shift formula is: position -= newOrigin
 	/// @param newOrigin the new origin with respect to the old origin
@@ -112,12 +122,18 @@ private:
 
 	friend class b2DynamicTree;
 
+	static bool IsStaticProxy(int32 proxyId);
+	static int32 GetTreeProxyId(int32 proxyId);
+	b2DynamicTree& GetTree(int32 proxyId);
+	const b2DynamicTree& GetTree(int32 proxyId) const;
+
 	void BufferMove(int32 proxyId);
 	void UnBufferMove(int32 proxyId);
 
 	bool QueryCallback(int32 proxyId);
 
-	b2DynamicTree m_tree;
+	b2DynamicTree m_dynamicTree;
+	b2DynamicTree m_staticTree;
 
 	int32 m_proxyCount;
 
@@ -130,23 +146,75 @@ private:
 	int32 m_pairCount;
 
 	int32 m_queryProxyId;
+	int32 m_queryTreeFlag;
+};
+
+/// Hands the callback broad-phase proxy ids while it is driven by one of the trees,
+/// and remembers when it asked to stop so the other tree is skipped.
+template <typename T>
+struct b2BroadPhaseTreeCallback
+{
+	bool QueryCallback(int32 proxyId)
+	{
+		terminated = callback->QueryCallback(proxyId | treeFlag) == false;
+		return terminated == false;
+	}
+
+	float RayCastCallback(const b2RayCastInput& input, int32 proxyId)
+	{
+		float value = callback->RayCastCallback(input, proxyId | treeFlag);
+		if (value == 0.0f)
+		{
+			terminated = true;
+		}
+		else if (value > 0.0f)
+		{
+			maxFraction = value;
+		}
+		return value;
+	}
+
+	T* callback;
+	int32 treeFlag;
+	bool terminated;
+	float maxFraction;
 };
 
+inline bool b2BroadPhase::IsStaticProxy(int32 proxyId)
+{
+	return (proxyId & e_staticProxyFlag) != 0;
+}
+
+inline int32 b2BroadPhase::GetTreeProxyId(int32 proxyId)
+{
+	return proxyId & ~e_staticProxyFlag;
+}
+
+inline b2DynamicTree& b2BroadPhase::GetTree(int32 proxyId)
+{
+	return IsStaticProxy(proxyId) ? m_staticTree : m_dynamicTree;
+}
+
+inline const b2DynamicTree& b2BroadPhase::GetTree(int32 proxyId) const
+{
+	return IsStaticProxy(proxyId) ? m_staticTree : m_dynamicTree;
+}
+
 inline void* b2BroadPhase::GetUserData(int32 proxyId) const
 {
-	return m_tree.GetUserData(proxyId);
+	return GetTree(proxyId).GetUserData(GetTreeProxyId(proxyId));
 }
 
 inline bool b2BroadPhase::TestOverlap(int32 proxyIdA, int32 proxyIdB) const
 {
-	const b2AABB& aabbA = m_tree.GetFatAABB(proxyIdA);
-	const b2AABB& aabbB = m_tree.GetFatAABB(proxyIdB);
+	const b2AABB& aabbA = GetFatAABB(proxyIdA);
+	const b2AABB& aabbB = GetFatAABB(proxyIdB);
 	return b2TestOverlap(aabbA, aabbB);
 }
 
 inline const b2AABB& b2BroadPhase::GetFatAABB(int32 proxyId) const
 {
-	return m_tree.GetFatAABB(proxyId);
+	return GetTree(proxyId).GetFatAABB(GetTreeProxyId(proxyId));
 }
 
 inline int32 b2BroadPhase::GetProxyCount() const
@@ -156,17 +224,23 @@ inline int32 b2BroadPhase::GetProxyCount() const
 
 inline int32 b2BroadPhase::GetTreeHeight() const
 {
-	return m_tree.GetHeight();
+	return b2Max(m_dynamicTree.GetHeight(), m_staticTree.GetHeight());
 }
 
 inline int32 b2BroadPhase::GetTreeBalance() const
 {
-	return m_tree.GetMaxBalance();
+	return b2Max(m_dynamicTree.GetMaxBalance(), m_staticTree.GetMaxBalance());
 }
 
 inline float b2BroadPhase::GetTreeQuality() const
 {
-	return m_tree.GetAreaRatio();
+	return m_dynamicTree.GetAreaRatio();
+}
+
+inline void b2BroadPhase::RebuildTrees()
+{
+	m_staticTree.RebuildTopDown();
+	m_dynamicTree.RebuildTopDown();
 }
 
 template <typename T>
@@ -186,18 +260,26 @@ void b2BroadPhase::UpdatePairs(T* callback)
 
 		// We have to query the tree with the fat AABB so that
 		// we don't fail to create a pair that may touch later.
-		const b2AABB& fatAABB = m_tree.GetFatAABB(m_queryProxyId);
+		const b2AABB& fatAABB = GetFatAABB(m_queryProxyId);
 
 		// Query tree, create pairs and add them pair buffer.
-		m_tree.Query(this, fatAABB);
+		m_queryTreeFlag = 0;
+		m_dynamicTree.Query(this, fatAABB);
+
+		// Static proxies don't pair with each other.
+		if (IsStaticProxy(m_queryProxyId) == false)
+		{
+			m_queryTreeFlag = e_staticProxyFlag;
+			m_staticTree.Query(this, fatAABB);
+		}
 	}
 
 	// Send pairs to caller
 	for (int32 i = 0; i < m_pairCount; ++i)
 	{
 		b2Pair* primaryPair = m_pairBuffer + i;
-		void* userDataA = m_tree.GetUserData(primaryPair->proxyIdA);
-		void* userDataB = m_tree.GetUserData(primaryPair->proxyIdB);
+		void* userDataA = GetUserData(primaryPair->proxyIdA);
+		void* userDataB = GetUserData(primaryPair->proxyIdB);
 
 		callback->AddPair(userDataA, userDataB);
 	}
@@ -211,7 +293,7 @@ void b2BroadPhase::UpdatePairs(T* callback)
 			continue;
 		}
 
-		m_tree.ClearMoved(proxyId);
+		GetTree(proxyId).ClearMoved(GetTreeProxyId(proxyId));
 	}
 
 	// Reset move buffer
@@ -221,18 +303,38 @@ void b2BroadPhase::UpdatePairs(T* callback)
 template <typename T>
 inline void b2BroadPhase::Query(T* callback, const b2AABB& aabb) const
 {
-	m_tree.Query(callback, aabb);
+	b2BroadPhaseTreeCallback<T> wrapper = { callback, 0, false, 0.0f };
+	m_dynamicTree.Query(&wrapper, aabb);
+	if (wrapper.terminated)
+	{
+		return;
+	}
+
+	wrapper.treeFlag = e_staticProxyFlag;
+	m_staticTree.Query(&wrapper, aabb);
 }
 
 template <typename T>
 inline void b2BroadPhase::RayCast(T* callback, const b2RayCastInput& input) const
 {
-	m_tree.RayCast(callback, input);
+	b2BroadPhaseTreeCallback<T> wrapper = { callback, 0, false, input.maxFraction };
+	m_dynamicTree.RayCast(&wrapper, input);
+	if (wrapper.terminated)
+	{
+		return;
+	}
+
+	// Hits in the dynamic tree have already clipped the ray.
+	b2RayCastInput staticInput = input;
+	staticInput.maxFraction = wrapper.maxFraction;
+	wrapper.treeFlag = e_staticProxyFlag;
+	m_staticTree.RayCast(&wrapper, staticInput);
 }
 
 inline void b2BroadPhase::ShiftOrigin(const b2Vec2& newOrigin)
 {
-	m_tree.ShiftOrigin(newOrigin);
+	m_dynamicTree.ShiftOrigin(newOrigin);
+	m_staticTree.ShiftOrigin(newOrigin);
 }
 
 #endif
@@ -210,6 +210,11 @@ protected:
 
 	void Update(b2ContactListener* listener);
 
+	// Update in two halves. UpdateManifold only writes this contact, so many contacts can run it at once.
+	// ReportUpdate wakes the bodies and calls the listener, and must run on one thread.
+	void UpdateManifold(b2Manifold* oldManifold, bool* wasTouching);
+	void ReportUpdate(b2ContactListener* listener, const b2Manifold& oldManifold, bool wasTouching);
+
 	static b2ContactRegister s_registers[b2Shape::e_typeCount][b2Shape::e_typeCount];
 	static bool s_initialized;
 
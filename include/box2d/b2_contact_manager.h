@@ -23,13 +23,25 @@
 #ifndef B2_CONTACT_MANAGER_H
 #define B2_CONTACT_MANAGER_H
 
+#include <vector>
+
 #include "b2_api.h"
 #include "b2_broad_phase.h"
+#include "b2_collision.h"
 
 class b2Contact;
 class b2ContactFilter;
 class b2ContactListener;
 class b2BlockAllocator;
+class b2ThreadPool;
+
+// A contact whose manifold was updated in the narrowphase, waiting to be reported.
+struct b2NarrowphaseContact
+{
+	b2Contact* contact;
+	b2Manifold oldManifold;
+	bool wasTouching;
+};
 
 // Delegate of b2World.
 class B2_API b2ContactManager
@@ -46,12 +58,18 @@ public:
 
 	void Collide();
 
+	static void UpdateManifoldsTask(void* context, int32 index, int32 threadIndex);
+
 	b2BroadPhase m_broadPhase;
 	b2Contact* m_contactList;
 	int32 m_contactCount;
 	b2ContactFilter* m_contactFilter;
 	b2ContactListener* m_contactListener;
 	b2BlockAllocator* m_allocator;
+
+	// Set by b2World::SetWorkerCount, manifolds are updated on the calling thread when null
+	b2ThreadPool* m_threadPool;
+	std::vector<b2NarrowphaseContact> m_narrowphase;
 };
 
 #endif
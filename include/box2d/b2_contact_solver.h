@@ -31,6 +31,7 @@ class b2Contact;
 class b2Body;
 class b2StackAllocator;
 struct b2ContactPositionConstraint;
+struct b2ContactConstraintWide;
 
 struct b2VelocityConstraintPoint
 {
@@ -81,8 +82,14 @@ public:
 
 	void WarmStart();
 	void SolveVelocityConstraints();
+	void SolveVelocityConstraint(b2ContactVelocityConstraint* vc);
 	void StoreImpulses();
 
+	// Wide path, only used when m_step.wideContacts is set and there are enough contacts
+	void ColorConstraints();
+	void PrepareWideConstraints();
+	void SolveWideVelocityConstraint(b2ContactConstraintWide* wc);
+
 	bool SolvePositionConstraints();
 	bool SolveTOIPositionConstraints(int32 toiIndexA, int32 toiIndexB);
 
@@ -94,6 +101,13 @@ public:
 	b2ContactVelocityConstraint* m_velocityConstraints;
 	b2Contact** m_contacts;
 	int m_count;
+
+	// Batches of constraints that share no dynamic body, in color order. Whatever doesn't fill a batch
+	// is listed in m_scalarIndices and solved one at a time after them.
+	b2ContactConstraintWide* m_wideConstraints;
+	int32 m_wideCount;
+	int32* m_scalarIndices;
+	int32 m_scalarCount;
 };
 
 #endif
@@ -128,6 +128,10 @@ public:
 	/// Build an optimal tree. Very expensive. For testing.
 	void RebuildBottomUp();
 
+	/// Build a high quality tree top-down, splitting the leaves with the surface area heuristic.
+	/// O(n log n), meant for trees that are filled once and then rarely change. Proxy ids are kept.
+	void RebuildTopDown();
+
 	/// Shift the world origin. Useful for large worlds.
 	/// The shift formula is: position -= newOrigin
 	/// @param newOrigin the new origin with respect to the old origin
@@ -31,6 +31,7 @@ class b2Contact;
 class b2Joint;
 class b2StackAllocator;
 class b2ContactListener;
+struct b2ContactImpulse;
 struct b2ContactVelocityConstraint;
 struct b2Profile;
 
@@ -61,6 +62,15 @@ public:
 		++m_bodyCount;
 	}
 
+	/// For islands solved in parallel. The world has already set m_islandIndex, static bodies are shared
+	/// between islands so they keep one index for the whole step and the state arrays are sized to match.
+	void AddIndexed(b2Body* body)
+	{
+		b2Assert(m_bodyCount < m_bodyCapacity);
+		m_bodies[m_bodyCount] = body;
+		++m_bodyCount;
+	}
+
 	void Add(b2Contact* contact)
 	{
 		b2Assert(m_contactCount < m_contactCapacity);
@@ -78,6 +88,9 @@ public:
 	b2StackAllocator* m_allocator;
 	b2ContactListener* m_listener;
 
+	// When set, Report stores one impulse per contact here instead of calling the listener
+	b2ContactImpulse* m_deferredImpulses;
+
 	b2Body** m_bodies;
 	b2Contact** m_contacts;
 	b2Joint** m_joints;
@@ -146,6 +146,22 @@ struct B2_API b2Vec2
 		return v;
 	}
 
+	/// In place versions of the above, for Lua code that reuses one vector instead of allocating a new one per operation.
+	void Add(const b2Vec2& other)
+	{
+		x += other.x; y += other.y;
+	}
+
+	void Sub(const b2Vec2& other)
+	{
+		x -= other.x; y -= other.y;
+	}
+
+	void Scale(const float multiplier)
+	{
+		x *= multiplier; y *= multiplier;
+	}
+
 	float x, y;
 };
 
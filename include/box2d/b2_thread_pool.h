@@ -0,0 +1,69 @@
+// b2_thread_pool.h
+
+#ifndef B2_THREAD_POOL_H
+#define B2_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "b2_api.h"
+#include "b2_settings.h"
+
+class b2StackAllocator;
+
+/// A task run by b2ThreadPool::ParallelFor. threadIndex is 0 on the calling thread and 1 to GetWorkerCount() on the
+/// workers, so tasks can keep per thread state without locking.
+typedef void b2ParallelTask(void* context, int32 index, int32 threadIndex);
+
+// A small fixed pool of worker threads for splitting a step into independent pieces. ParallelFor hands out
+// indices from a shared counter, so a thread that finishes early takes the next piece instead of idling.
+// The calling thread works too and ParallelFor returns once every index has run.
+class B2_API b2ThreadPool
+{
+public:
+	b2ThreadPool(int32 workerCount);
+	~b2ThreadPool();
+
+	/// Run task for every index in [0, count). Runs inline when there are no workers or only one index.
+	void ParallelFor(int32 count, b2ParallelTask* task, void* context);
+
+	/// Number of threads besides the calling one.
+	int32 GetWorkerCount() const;
+
+	/// Stack allocator owned by one thread, for per step allocations made inside a task.
+	b2StackAllocator* GetStackAllocator(int32 threadIndex);
+
+private:
+	void WorkerMain(int32 threadIndex);
+	void RunTasks(int32 threadIndex);
+
+	std::vector<std::thread> m_threads;
+	std::vector<b2StackAllocator*> m_allocators;
+
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_done;
+	uint32 m_generation;
+	int32 m_busyWorkers;
+	bool m_quit;
+
+	b2ParallelTask* m_task;
+	void* m_context;
+	int32 m_taskCount;
+	std::atomic<int32> m_nextIndex;
+};
+
+inline int32 b2ThreadPool::GetWorkerCount() const
+{
+	return int32(m_threads.size());
+}
+
+inline b2StackAllocator* b2ThreadPool::GetStackAllocator(int32 threadIndex)
+{
+	return m_allocators[threadIndex];
+}
+
+#endif
@@ -47,6 +47,7 @@ struct B2_API b2TimeStep
 	int32 velocityIterations;
 	int32 positionIterations;
 	bool warmStarting;
+	bool wideContacts;	// solve contact velocities in colored SIMD batches
 };
 
 /// This is an internal structure.
@@ -39,6 +39,8 @@ class b2Body;
 class b2Draw;
 class b2Fixture;
 class b2Joint;
+class b2ThreadPool;
+struct b2ParallelIslands;
 
 /// The world class manages all physics entities, dynamic simulation,
 /// and asynchronous queries. The world also contains efficient memory
@@ -150,6 +152,18 @@ public:
 	void SetAllowSleeping(bool flag);
 	bool GetAllowSleeping() const { return m_allowSleep; }
 
+	/// Solve independent islands on this many threads besides the one calling Step. 0, the default,
+	/// solves every island on the calling thread. Results don't depend on the count.
+	/// @warning this should be called outside of a time step.
+	void SetWorkerCount(int32 count);
+	int32 GetWorkerCount() const;
+
+	/// Solve contact velocities four at a time with SIMD. Contacts are graph colored so no dynamic body
+	/// appears twice in a batch. That changes the order contacts are solved in, so results differ slightly
+	/// from the default solver.
+	void SetWideContactSolver(bool flag) { m_wideContacts = flag; }
+	bool GetWideContactSolver() const { return m_wideContacts; }
+
 	/// Enable/disable warm starting. For testing.
 	void SetWarmStarting(bool flag) { m_warmStarting = flag; }
 	bool GetWarmStarting() const { return m_warmStarting; }
@@ -204,6 +218,11 @@ public:
 	/// @param newOrigin the new origin with respect to the old origin
 	void ShiftOrigin(const b2Vec2& newOrigin);
 
+	/// Rebuild the broad-phase trees for faster collision detection and queries. Worth calling
+	/// once the bodies of a level are created, one at a time insertion leaves them poorly
+	/// organized and the tree of static bodies is never rebalanced otherwise.
+	void RebuildBroadPhase();
+
 	/// Get the contact manager for testing.
 	const b2ContactManager& GetContactManager() const;
 
@@ -222,6 +241,9 @@ private:
 	friend class b2Controller;
 
 	void Solve(const b2TimeStep& step);
+	void SolveIslands(const b2TimeStep& step);
+	void SolveIslandsInParallel(const b2TimeStep& step);
+	static void SolveIslandTask(void* context, int32 index, int32 threadIndex);
 	void SolveTOI(const b2TimeStep& step);
 
 	void DrawShape(b2Fixture* shape, const b2Transform& xf, const b2Color& color);
@@ -255,10 +277,15 @@ private:
 	bool m_warmStarting;
 	bool m_continuousPhysics;
 	bool m_subStepping;
+	bool m_wideContacts;
 
 	bool m_stepComplete;
 
 	b2Profile m_profile;
+
+	// Null until SetWorkerCount asks for workers
+	b2ThreadPool* m_threadPool;
+	b2ParallelIslands* m_parallelIslands;
 };
 
 inline b2Body* b2World::GetBodyList()
@@ -1,4 +1,5 @@
 #include "Actor.h"
+#include "SceneManager.h"
 
 
 Actor::Actor() : id(-1), name("") {};
@@ -18,6 +19,30 @@ Actor& Actor::operator=(const Actor& other) {
                 continue;
             }
 
+            if (parentScript["type"].tostring() == "Tilemap") {
+                luabridge::LuaRef newTilemap = ComponentManager::CreateNewTilemap(parentScript, this);
+                InjectConvenienceReference(newTilemap);
+                components.insert(std::pair(otherPair.first, newTilemap));
+                componentsByType[newTilemap["type"].tostring()].insert(otherPair.first);
+                continue;
+            }
+
+            if (parentScript["type"].tostring() == "ParticleEmitter") {
+                luabridge::LuaRef newEmitter = ComponentManager::CreateNewParticleEmitter(parentScript, this);
+                InjectConvenienceReference(newEmitter);
+                components.insert(std::pair(otherPair.first, newEmitter));
+                componentsByType[newEmitter["type"].tostring()].insert(otherPair.first);
+                continue;
+            }
+
+            if (parentScript["type"].tostring() == "Transform") {
+                luabridge::LuaRef newTransform = ComponentManager::CreateNewTransform(parentScript, this);
+                InjectConvenienceReference(newTransform);
+                components.insert(std::pair(otherPair.first, newTransform));
+                componentsByType[newTransform["type"].tostring()].insert(otherPair.first);
+                continue;
+            }
+
             luabridge::LuaRef instanceScript = luabridge::newTable(luaState);
             ComponentManager::EstablishInheritance(instanceScript, parentScript);
             InjectConvenienceReference(instanceScript);
@@ -104,6 +129,8 @@ luabridge::LuaRef Actor::GetComponents(const std::string& type) {
 }
 
 luabridge::LuaRef Actor::AddComponent(const std::string& type) {
+    poolable = false;
+    SceneManager::QueueComponentChanges(this);
     luabridge::LuaRef component = ComponentManager::LoadComponentRuntime(type);
     InjectConvenienceReference(component);
     componentAddQueue.push_back(component);
@@ -112,11 +139,19 @@ luabridge::LuaRef Actor::AddComponent(const std::string& type) {
 }
 
 void Actor::RemoveComponent(luabridge::LuaRef component) {
+    poolable = false;
+    SceneManager::QueueComponentChanges(this);
     component["enabled"] = false;
     componentsToRemove.insert(std::pair(component["key"].tostring(), component));
 }
 
 void Actor::ProcessComponentQueues() {
+    // An actor headed back to its pool keeps its components, they are reset and reused with it
+    if (destroyed && poolable) {
+        componentsToRemove.clear();
+        return;
+    }
+
     for (luabridge::LuaRef component : componentAddQueue) {
         std::string key = component["key"].tostring();
         AddComponentLifecycle(component, key);
@@ -134,9 +169,7 @@ void Actor::ProcessComponentQueues() {
         typedComponents.erase(component.first);
 
         components.erase(component.first);
-        onStartComponents.erase(component.first);
-        onUpdateComponents.erase(component.first);
-        onLateUpdateComponents.erase(component.first);
+        SceneManager::RemoveComponentLifecycle(component.second);
     }
 
     componentAddQueue.clear();
@@ -146,17 +179,24 @@ void Actor::ProcessComponentQueues() {
 void Actor::AddComponentLifecycle(luabridge::LuaRef component, const std::string& key) {
     luabridge::LuaRef lifecycleFunction = component["OnStart"];
     if (lifecycleFunction.isFunction()) {
-        onStartComponents.insert(std::pair(key, component));
+        SceneManager::AddComponentLifecycle(this, key, component, OnStart, lifecycleFunction);
     }
 
-    lifecycleFunction = component["OnUpdate"];
+    // Types that opt into batching are updated once per frame for all instances, OnUpdate is ignored
+    lifecycleFunction = component["OnUpdateBatch"];
     if (lifecycleFunction.isFunction()) {
-        onUpdateComponents.insert(std::pair(key, component));
+        SceneManager::AddComponentUpdateBatch(this, key, component, component["type"].tostring(), lifecycleFunction);
+    }
+    else {
+        lifecycleFunction = component["OnUpdate"];
+        if (lifecycleFunction.isFunction()) {
+            SceneManager::AddComponentLifecycle(this, key, component, OnUpdate, lifecycleFunction);
+        }
     }
 
     lifecycleFunction = component["OnLateUpdate"];
     if (lifecycleFunction.isFunction()) {
-        onLateUpdateComponents.insert(std::pair(key, component));
+        SceneManager::AddComponentLifecycle(this, key, component, OnLateUpdate, lifecycleFunction);
     }
 
     lifecycleFunction = component["OnCollisionEnter"];
@@ -214,7 +254,109 @@ void Actor::ProcessDestroyedComponents() {
 }
 
 void Actor::SetupForDestruction() {
+    destroyed = true;
+    SceneManager::QueueComponentChanges(this);
+
     for (const auto& component : components) {
         componentsToRemove.insert(std::pair(component.first, component.second));
     }
 }
+
+// Puts a destroyed actor back into the state Instantiate would have created it in.
+// Lifecycle functions are registered again when the actor is reused.
+void Actor::ResetToTemplate(const Actor& actorTemplate) {
+    name = actorTemplate.name;
+    enabled = true;
+    destroyed = false;
+    componentChangesQueued = false;
+
+    componentAddQueue.clear();
+    componentsToRemove.clear();
+    onDestroyComponents.clear();
+    onCollisionEnterComponents.clear();
+    onCollisionExitComponents.clear();
+    onTriggerEnterComponents.clear();
+    onTriggerExitComponents.clear();
+
+    for (auto& componentPair : components) {
+        ComponentManager::ResetComponent(componentPair.second, actorTemplate.components.find(componentPair.first)->second);
+    }
+}
+
+bool ActorHandle::IsValid() const {
+    return SceneManager::ResolveActor(*this) != nullptr;
+}
+
+luabridge::LuaRef ActorHandle::GetName() const {
+    Actor* actor = SceneManager::ResolveActor(*this);
+    if (actor == nullptr)
+        return luabridge::LuaRef(Actor::luaState);
+
+    return luabridge::LuaRef(Actor::luaState, actor->GetName());
+}
+
+luabridge::LuaRef ActorHandle::GetID() const {
+    Actor* actor = SceneManager::ResolveActor(*this);
+    if (actor == nullptr)
+        return luabridge::LuaRef(Actor::luaState);
+
+    return luabridge::LuaRef(Actor::luaState, actor->GetID());
+}
+
+luabridge::LuaRef ActorHandle::GetComponentByKey(const std::string& key) const {
+    Actor* actor = SceneManager::ResolveActor(*this);
+    if (actor == nullptr)
+        return luabridge::LuaRef(Actor::luaState);
+
+    return actor->GetComponentByKey(key);
+}
+
+luabridge::LuaRef ActorHandle::GetComponent(const std::string& type) const {
+    Actor* actor = SceneManager::ResolveActor(*this);
+    if (actor == nullptr)
+        return luabridge::LuaRef(Actor::luaState);
+
+    return actor->GetComponent(type);
+}
+
+luabridge::LuaRef ActorHandle::GetComponents(const std::string& type) const {
+    Actor* actor = SceneManager::ResolveActor(*this);
+    if (actor == nullptr)
+        return luabridge::LuaRef(Actor::luaState);
+
+    return actor->GetComponents(type);
+}
+
+luabridge::LuaRef ActorHandle::AddComponent(const std::string& type) const {
+    Actor* actor = SceneManager::ResolveActor(*this);
+    if (actor == nullptr)
+        return luabridge::LuaRef(Actor::luaState);
+
+    return actor->AddComponent(type);
+}
+
+void ActorHandle::RemoveComponent(luabridge::LuaRef component) const {
+    Actor* actor = SceneManager::ResolveActor(*this);
+    if (actor != nullptr)
+        actor->RemoveComponent(component);
+}
+
+void luabridge::Stack<Actor*>::push(lua_State* L, Actor* actor) {
+    if (actor == nullptr) {
+        lua_pushnil(L);
+        return;
+    }
+
+    Stack<ActorHandle>::push(L, actor->GetHandle());
+}
+
+Actor* luabridge::Stack<Actor*>::get(lua_State* L, int index) {
+    if (lua_isnil(L, index))
+        return nullptr;
+
+    return SceneManager::ResolveActor(*detail::Userdata::get<ActorHandle>(L, index, true));
+}
+
+bool luabridge::Stack<Actor*>::isInstance(lua_State* L, int index) {
+    return lua_isnil(L, index) || Stack<ActorHandle>::isInstance(L, index);
+}
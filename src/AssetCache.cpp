@@ -0,0 +1,621 @@
+#include "AssetCache.h"
+#include "rapidjson/document.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static constexpr char assetMagic[4] = { 'S', 'R', 'L', 'A' };
+static constexpr uint32_t assetVersion = 2; // Bump whenever the layout changes, older caches are recompiled
+
+// Cached component types: "SRLB" magic, u32 LUA_VERSION_NUM, u64 FNV-1a hash of the source, then the lua_dump output
+static constexpr char scriptMagic[4] = { 'S', 'R', 'L', 'B' };
+static constexpr size_t scriptHeaderSize = 16;
+
+const uint8_t* AssetReader::ReadBytes(size_t size) {
+    if (static_cast<size_t>(end - cursor) < size) {
+        std::cout << "error: compiled asset for " << *path << " is corrupt";
+        exit(0);
+    }
+
+    const uint8_t* value = cursor;
+    cursor += size;
+    return value;
+}
+
+uint32_t AssetReader::ReadUInt() {
+    uint32_t value;
+    std::memcpy(&value, ReadBytes(sizeof(value)), sizeof(value));
+    return value;
+}
+
+int32_t AssetReader::ReadInt() {
+    int32_t value;
+    std::memcpy(&value, ReadBytes(sizeof(value)), sizeof(value));
+    return value;
+}
+
+double AssetReader::ReadDouble() {
+    double value;
+    std::memcpy(&value, ReadBytes(sizeof(value)), sizeof(value));
+    return value;
+}
+
+uint8_t AssetReader::ReadByte() {
+    return *ReadBytes(1);
+}
+
+void AssetReader::ReadInts(std::vector<int>& out) {
+    uint32_t count = ReadUInt();
+    const uint8_t* values = ReadBytes(count * sizeof(int32_t));
+    out.resize(count);
+    std::memcpy(out.data(), values, count * sizeof(int32_t));
+}
+
+void AssetReader::SkipInts() {
+    uint32_t count = ReadUInt();
+    ReadBytes(count * sizeof(int32_t));
+}
+
+CompiledAsset::~CompiledAsset() {
+    Unmap();
+}
+
+bool CompiledAsset::Map(const std::string& compiledPath) {
+    Unmap();
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(compiledPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE fileMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (fileMapping == nullptr)
+        return false;
+
+    // The view keeps the file mapped after both handles are closed
+    void* view = MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(fileMapping);
+    if (view == nullptr)
+        return false;
+
+    size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int file = open(compiledPath.c_str(), O_RDONLY);
+    if (file == -1)
+        return false;
+
+    struct stat fileStat;
+    if (fstat(file, &fileStat) != 0 || fileStat.st_size == 0) {
+        close(file);
+        return false;
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (view == MAP_FAILED)
+        return false;
+
+    size = static_cast<size_t>(fileStat.st_size);
+#endif
+
+    mapping = view;
+    data = static_cast<const uint8_t*>(view);
+    return true;
+}
+
+void CompiledAsset::Unmap() {
+    if (mapping != nullptr) {
+#if defined(_WIN32)
+        UnmapViewOfFile(mapping);
+#else
+        munmap(mapping, size);
+#endif
+        mapping = nullptr;
+    }
+
+    ownedBytes.clear();
+    strings.clear();
+    templateNames.clear();
+    luaStrings.clear();
+    data = nullptr;
+    size = 0;
+}
+
+void CompiledAsset::Adopt(std::vector<uint8_t>&& bytes) {
+    Unmap();
+    ownedBytes = std::move(bytes);
+    data = ownedBytes.data();
+    size = ownedBytes.size();
+}
+
+// Indexes the string table. Returns false for anything written by a different version of the engine, or cut short,
+// so it gets compiled again. This runs on the scene loading thread and must not exit.
+bool CompiledAsset::ReadHeader() {
+    strings.clear();
+    templateNames.clear();
+    luaStrings.clear();
+
+    if (size < sizeof(assetMagic) + sizeof(uint32_t) || std::memcmp(data, assetMagic, sizeof(assetMagic)) != 0)
+        return false;
+
+    AssetReader reader(data + sizeof(assetMagic), data + size, &path);
+
+    if (reader.ReadUInt() != assetVersion)
+        return false;
+
+    if (!reader.CanRead(sizeof(uint32_t)))
+        return false;
+
+    // Every string has at least its length, so a count past that is garbage and not worth reserving for
+    uint32_t numStrings = reader.ReadUInt();
+    if (!reader.CanRead(static_cast<size_t>(numStrings) * sizeof(uint32_t)))
+        return false;
+
+    strings.reserve(numStrings);
+
+    for (uint32_t i = 0; i < numStrings; i++) {
+        if (!reader.CanRead(sizeof(uint32_t)))
+            return false;
+
+        uint32_t length = reader.ReadUInt();
+        if (!reader.CanRead(length))
+            return false;
+
+        strings.emplace_back(reinterpret_cast<const char*>(reader.ReadBytes(length)), length);
+    }
+
+    if (!reader.CanRead(sizeof(uint32_t)))
+        return false;
+
+    uint32_t numTemplates = reader.ReadUInt();
+    if (!reader.CanRead(static_cast<size_t>(numTemplates) * sizeof(uint32_t)))
+        return false;
+
+    templateNames.reserve(numTemplates);
+
+    for (uint32_t i = 0; i < numTemplates; i++) {
+        uint32_t templateName = reader.ReadUInt();
+        if (templateName >= strings.size())
+            return false;
+
+        templateNames.push_back(strings[templateName]);
+    }
+
+    actorsOffset = static_cast<size_t>(reader.GetCursor() - data);
+    return true;
+}
+
+std::string_view CompiledAsset::GetString(uint32_t index) const {
+    if (index >= strings.size()) {
+        std::cout << "error: compiled asset for " << path << " is corrupt";
+        exit(0);
+    }
+
+    return strings[index];
+}
+
+// Each distinct key and string value becomes a Lua string once per asset, instead of once per assignment
+const luabridge::LuaRef& CompiledAsset::GetLuaString(lua_State* L, uint32_t index) {
+    std::string_view value = GetString(index);
+
+    if (luaStrings.empty())
+        luaStrings.assign(strings.size(), luabridge::LuaRef(L));
+
+    luabridge::LuaRef& luaString = luaStrings[index];
+
+    if (luaString.isNil()) {
+        lua_pushlstring(L, value.data(), value.size());
+        luaString = luabridge::LuaRef::fromStack(L);
+    }
+
+    return luaString;
+}
+
+AssetReader CompiledAsset::GetActors() const {
+    return AssetReader(data + actorsOffset, data + size, &path);
+}
+
+std::shared_ptr<CompiledAsset> AssetCache::Load(const std::string& sourcePath) {
+    try {
+        return TryLoad(sourcePath);
+    }
+    catch (const std::exception& e) {
+        std::cout << e.what();
+        exit(0);
+    }
+}
+
+std::shared_ptr<CompiledAsset> AssetCache::TryLoad(const std::string& sourcePath) {
+    std::promise<std::shared_ptr<CompiledAsset>> promise;
+    std::shared_future<std::shared_ptr<CompiledAsset>> loaded;
+    bool loadedElsewhere = false;
+
+    {
+        std::lock_guard<std::mutex> lock(assetsMutex);
+
+        auto it = assets.find(sourcePath);
+        if (it != std::end(assets)) {
+            loaded = it->second;
+            loadedElsewhere = true;
+        }
+        else {
+            assets.emplace(sourcePath, promise.get_future().share());
+        }
+    }
+
+    // Ready unless another thread is still compiling this same asset. Rethrows if that compile failed.
+    if (loadedElsewhere)
+        return loaded.get();
+
+    std::shared_ptr<CompiledAsset> asset = std::make_shared<CompiledAsset>(sourcePath);
+    std::string compiledPath = GetCompiledPath(sourcePath);
+
+    std::error_code error;
+    bool upToDate = std::filesystem::exists(compiledPath, error)
+        && std::filesystem::last_write_time(compiledPath, error) >= std::filesystem::last_write_time(sourcePath, error)
+        && !error;
+
+    if (!upToDate || !asset->Map(compiledPath) || !asset->ReadHeader()) {
+        std::vector<uint8_t> bytes;
+        try {
+            bytes = Compile(sourcePath);
+        }
+        catch (...) {
+            // Anyone waiting on this asset gets the error too, instead of waiting forever
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+
+        Write(compiledPath, bytes);
+
+        // Use the fresh bytes directly, the cache only has to be valid for the next run
+        asset->Adopt(std::move(bytes));
+        asset->ReadHeader();
+    }
+
+    promise.set_value(asset);
+    return asset;
+}
+
+static bool ReadWholeFile(const std::string& path, std::string& contents) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file)
+        return false;
+
+    contents.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(contents.data(), static_cast<std::streamsize>(contents.size()));
+    return static_cast<bool>(file);
+}
+
+static uint64_t HashSource(const std::string& source) {
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : source) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static void WriteScriptHeader(std::vector<uint8_t>& bytes, uint64_t sourceHash) {
+    uint32_t luaVersion = LUA_VERSION_NUM;
+    bytes.resize(scriptHeaderSize);
+    std::memcpy(bytes.data(), scriptMagic, sizeof(scriptMagic));
+    std::memcpy(bytes.data() + 4, &luaVersion, sizeof(luaVersion));
+    std::memcpy(bytes.data() + 8, &sourceHash, sizeof(sourceHash));
+}
+
+static int AppendChunk(lua_State* L, const void* data, size_t size, void* userData) {
+    std::vector<uint8_t>* bytes = static_cast<std::vector<uint8_t>*>(userData);
+    const uint8_t* begin = static_cast<const uint8_t*>(data);
+    bytes->insert(std::end(*bytes), begin, begin + size);
+    return 0;
+}
+
+// Hashing the source is far cheaper than parsing it, and unlike a timestamp it survives checkouts and copies
+int AssetCache::LoadScript(lua_State* L, const std::string& sourcePath) {
+    std::string source;
+    if (!ReadWholeFile(sourcePath, source)) {
+        lua_pushfstring(L, "cannot open %s", sourcePath.c_str());
+        return LUA_ERRFILE;
+    }
+
+    std::string compiled;
+    if (ReadWholeFile(GetCompiledPath(sourcePath), compiled) && compiled.size() > scriptHeaderSize) {
+        std::vector<uint8_t> expectedHeader;
+        WriteScriptHeader(expectedHeader, HashSource(source));
+
+        if (std::memcmp(compiled.data(), expectedHeader.data(), scriptHeaderSize) == 0) {
+            std::string chunkName = "@" + sourcePath;
+            if (luaL_loadbufferx(L, compiled.data() + scriptHeaderSize, compiled.size() - scriptHeaderSize, chunkName.c_str(), "b") == LUA_OK)
+                return LUA_OK;
+
+            lua_pop(L, 1); // Dumped by a differently built Lua, compile it again
+        }
+    }
+
+    return CompileScript(L, sourcePath, source);
+}
+
+// Leaves the chunk on the stack like luaL_loadbuffer does
+int AssetCache::CompileScript(lua_State* L, const std::string& sourcePath, const std::string& source) {
+    std::string chunkName = "@" + sourcePath;
+    int status = luaL_loadbufferx(L, source.data(), source.size(), chunkName.c_str(), "t");
+    if (status != LUA_OK)
+        return status;
+
+    std::vector<uint8_t> bytes;
+    WriteScriptHeader(bytes, HashSource(source));
+    lua_dump(L, &AppendChunk, &bytes, 0); // Debug info is kept so errors still point at source lines
+
+    Write(GetCompiledPath(sourcePath), bytes);
+    return LUA_OK;
+}
+
+void AssetCache::CompileAll() {
+    int numCompiled = 0;
+
+    for (const char* folder : { "resources/scenes", "resources/actor_templates" }) {
+        if (!std::filesystem::exists(folder))
+            continue;
+
+        for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(folder)) {
+            std::string extension = entry.path().extension().string();
+            if (extension != ".scene" && extension != ".template")
+                continue;
+
+            std::string sourcePath = entry.path().generic_string();
+            try {
+                Write(GetCompiledPath(sourcePath), Compile(sourcePath));
+            }
+            catch (const std::exception& e) {
+                std::cout << e.what();
+                exit(0);
+            }
+            numCompiled++;
+        }
+    }
+
+    int numScripts = 0;
+    std::string componentFolder = "resources/component_types";
+
+    if (std::filesystem::exists(componentFolder)) {
+        lua_State* L = luaL_newstate();
+
+        for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(componentFolder)) {
+            if (entry.path().extension().string() != ".lua")
+                continue;
+
+            std::string sourcePath = entry.path().generic_string();
+            std::string source;
+            if (!ReadWholeFile(sourcePath, source)) {
+                std::cout << "error: failed to read " << sourcePath;
+                exit(0);
+            }
+
+            if (CompileScript(L, sourcePath, source) != LUA_OK) {
+                std::cout << "error: failed to compile " << sourcePath << ": " << lua_tostring(L, -1);
+                exit(0);
+            }
+
+            lua_pop(L, 1);
+            numScripts++;
+        }
+
+        lua_close(L);
+    }
+
+    std::cout << "compiled " << numCompiled << " scenes and templates and " << numScripts << " component types into " << cacheFolderPath << std::endl;
+}
+
+// resources/scenes/basic.scene -> resources/.cache/scenes/basic.scene.bin
+std::string AssetCache::GetCompiledPath(const std::string& sourcePath) {
+    std::string relativePath = sourcePath;
+    std::string resourcesPath = "resources/";
+
+    if (relativePath.compare(0, resourcesPath.size(), resourcesPath) == 0)
+        relativePath.erase(0, resourcesPath.size());
+
+    return cacheFolderPath + relativePath + ".bin";
+}
+
+// A read-only resources folder only costs the cache, the compiled bytes are still used for this run
+void AssetCache::Write(const std::string& compiledPath, const std::vector<uint8_t>& bytes) {
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(compiledPath).parent_path(), error);
+
+    // Written to the side and renamed, so a crash mid-write never leaves a truncated cache behind
+    std::string temporaryPath = compiledPath + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file)
+            return;
+
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!file)
+            return;
+    }
+
+    std::filesystem::rename(temporaryPath, compiledPath, error);
+}
+
+namespace {
+
+struct AssetWriter {
+    std::vector<uint8_t> actorBytes;
+    std::vector<std::string> strings;
+    std::unordered_map<std::string, uint32_t> stringIndices;
+    std::vector<uint32_t> templateNames;
+
+    uint32_t Intern(const std::string& value) {
+        auto it = stringIndices.find(value);
+        if (it != std::end(stringIndices))
+            return it->second;
+
+        uint32_t index = static_cast<uint32_t>(strings.size());
+        strings.push_back(value);
+        stringIndices[value] = index;
+        return index;
+    }
+
+    template <typename T>
+    static void Append(std::vector<uint8_t>& bytes, T value) {
+        size_t offset = bytes.size();
+        bytes.resize(offset + sizeof(T));
+        std::memcpy(bytes.data() + offset, &value, sizeof(T));
+    }
+
+    template <typename T>
+    void Append(T value) {
+        Append(actorBytes, value);
+    }
+
+    uint32_t InternMember(const rapidjson::Value& object, const char* member) {
+        if (!object.HasMember(member) || !object[member].IsString())
+            return noAssetString;
+
+        return Intern(object[member].GetString());
+    }
+
+    // Only the value types the JSON loader ever applied are kept, anything else was ignored before too
+    static bool IsSupported(const rapidjson::Value& value) {
+        return value.IsString() || value.IsInt() || value.IsDouble() || value.IsBool() || value.IsArray();
+    }
+
+    void WriteOverride(const std::string& memberName, const rapidjson::Value& value) {
+        Append(Intern(memberName));
+
+        if (value.IsString()) {
+            Append(static_cast<uint8_t>(COMPILED_STRING));
+            Append(Intern(value.GetString()));
+        }
+        else if (value.IsInt()) {
+            Append(static_cast<uint8_t>(COMPILED_INT));
+            Append(static_cast<int32_t>(value.GetInt()));
+        }
+        else if (value.IsDouble()) {
+            Append(static_cast<uint8_t>(COMPILED_DOUBLE));
+            Append(value.GetDouble());
+        }
+        else if (value.IsBool()) {
+            Append(static_cast<uint8_t>(COMPILED_BOOL));
+            Append(static_cast<uint8_t>(value.GetBool()));
+        }
+        else {
+            Append(static_cast<uint8_t>(COMPILED_INT_ARRAY));
+            Append(static_cast<uint32_t>(value.Size()));
+            for (const rapidjson::Value& element : value.GetArray()) {
+                Append(static_cast<int32_t>(element.IsInt() ? element.GetInt() : 0));
+            }
+        }
+    }
+
+    void WriteActor(const rapidjson::Value& actorObject) {
+        uint32_t templateName = InternMember(actorObject, "template");
+        Append(templateName);
+
+        if (templateName != noAssetString && std::find(std::begin(templateNames), std::end(templateNames), templateName) == std::end(templateNames))
+            templateNames.push_back(templateName);
+
+        Append(InternMember(actorObject, "name"));
+
+        if (!actorObject.HasMember("components") || !actorObject["components"].IsObject()) {
+            Append(static_cast<uint32_t>(0));
+            return;
+        }
+
+        const rapidjson::Value& componentsObject = actorObject["components"];
+        Append(static_cast<uint32_t>(componentsObject.MemberCount()));
+
+        for (rapidjson::Value::ConstMemberIterator componentsItr = componentsObject.MemberBegin(); componentsItr != componentsObject.MemberEnd(); componentsItr++) {
+            const rapidjson::Value& componentObject = componentsItr->value;
+
+            Append(Intern(componentsItr->name.GetString()));
+            Append(InternMember(componentObject, "type"));
+
+            uint32_t numOverrides = 0;
+            for (rapidjson::Value::ConstMemberIterator memberItr = componentObject.MemberBegin(); memberItr != componentObject.MemberEnd(); memberItr++) {
+                if (std::strcmp(memberItr->name.GetString(), "type") != 0 && IsSupported(memberItr->value))
+                    numOverrides++;
+            }
+            Append(numOverrides);
+
+            for (rapidjson::Value::ConstMemberIterator memberItr = componentObject.MemberBegin(); memberItr != componentObject.MemberEnd(); memberItr++) {
+                if (std::strcmp(memberItr->name.GetString(), "type") != 0 && IsSupported(memberItr->value))
+                    WriteOverride(memberItr->name.GetString(), memberItr->value);
+            }
+        }
+    }
+
+    std::vector<uint8_t> Finish(uint32_t numActors) {
+        std::vector<uint8_t> bytes(std::begin(assetMagic), std::end(assetMagic));
+        Append(bytes, assetVersion);
+        Append(bytes, static_cast<uint32_t>(strings.size()));
+
+        for (const std::string& value : strings) {
+            Append(bytes, static_cast<uint32_t>(value.size()));
+            bytes.insert(std::end(bytes), std::begin(value), std::end(value));
+        }
+
+        Append(bytes, static_cast<uint32_t>(templateNames.size()));
+        for (uint32_t templateName : templateNames) {
+            Append(bytes, templateName);
+        }
+
+        Append(bytes, numActors);
+        bytes.insert(std::end(bytes), std::begin(actorBytes), std::end(actorBytes));
+        return bytes;
+    }
+};
+
+}
+
+// Scenes hold an "actors" array, a template is a single actor. Throws instead of exiting, this can run on the
+// scene loading thread.
+std::vector<uint8_t> AssetCache::Compile(const std::string& sourcePath) {
+    std::string source;
+    if (!ReadWholeFile(sourcePath, source))
+        throw std::runtime_error("error: failed to read " + sourcePath);
+
+    rapidjson::Document document;
+    document.Parse(source.data(), source.size());
+    if (document.HasParseError())
+        throw std::runtime_error("error parsing json at [" + sourcePath + "]");
+
+    AssetWriter writer;
+    uint32_t numActors = 0;
+
+    if (document.HasMember("actors") && document["actors"].IsArray()) {
+        for (const rapidjson::Value& actorObject : document["actors"].GetArray()) {
+            writer.WriteActor(actorObject);
+            numActors++;
+        }
+    }
+    else {
+        writer.WriteActor(document);
+        numActors = 1;
+    }
+
+    return writer.Finish(numActors);
+}
@@ -1,6 +1,24 @@
 // ComponentManager.cpp
 #include "ComponentManager.h"
 #include "filesystem"
+#include <algorithm>
+#include <cstring>
+
+// __newindex for component instances. Writes to "enabled" update the C++ flag (upvalue 1) and the
+// table reads of "enabled" resolve to (upvalue 2). Everything else is stored on the instance as usual.
+static int ComponentNewIndex(lua_State* L) {
+    if (lua_type(L, 2) == LUA_TSTRING && std::strcmp(lua_tostring(L, 2), "enabled") == 0) {
+        ComponentState* state = static_cast<ComponentState*>(lua_touserdata(L, lua_upvalueindex(1)));
+        state->enabled = lua_toboolean(L, 3);
+        lua_pushvalue(L, 2);
+        lua_pushvalue(L, 3);
+        lua_rawset(L, lua_upvalueindex(2));
+        return 0;
+    }
+
+    lua_rawset(L, 1);
+    return 0;
+}
 
 bool ComponentManager::CheckLuaState() {
     if (luaState == nullptr) {
@@ -10,6 +28,44 @@ bool ComponentManager::CheckLuaState() {
     return false;
 }
 
+// Runs the component type's script the first time the type is used. The chunk comes from the bytecode cache when the
+// source hasn't changed since it was compiled.
+luabridge::LuaRef ComponentManager::LoadComponentType(const std::string& componentName) {
+    auto it = components.find(componentName);
+    if (it != components.end())
+        return it->second;
+
+    std::string filePath = componentFolderPath + componentName + ".lua";
+
+    if (!std::filesystem::exists(filePath)) {
+        std::cout << "error: failed to locate component " << componentName;
+        exit(0);
+    }
+
+    // Load component and check if it is a valid lua file
+    if (AssetCache::LoadScript(luaState, filePath) != LUA_OK || lua_pcall(luaState, 0, 0, 0) != LUA_OK) {
+        const char* lua_error_msg = lua_tostring(luaState, -1); // Get error message from top of Lua stack
+        std::cerr << "\033[31m" << "Error in Lua file '" << componentName << "': " << lua_error_msg << "\033[0m" << std::endl;
+        exit(0);
+    }
+
+    luabridge::LuaRef component = luabridge::getGlobal(luaState, componentName.c_str());
+    component["type"] = componentName;
+    component["enabled"] = true;
+    components.insert(std::pair(componentName, component));
+    return component;
+}
+
+void ComponentManager::PreloadComponentTypes() {
+    if (!std::filesystem::exists(componentFolderPath))
+        return;
+
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(componentFolderPath)) {
+        if (entry.path().extension().string() == ".lua")
+            LoadComponentType(entry.path().stem().string());
+    }
+}
+
 luabridge::LuaRef ComponentManager::LoadComponent(const std::string& componentKey, const std::string& componentName) {
     // Load C++ Components
     if (componentName == "Rigidbody") {
@@ -24,32 +80,44 @@ luabridge::LuaRef ComponentManager::LoadComponent(const std::string& componentKe
         return component;
     }
 
-    // Load Lua Components
-    auto it = components.find(componentName);
+    if (componentName == "Tilemap") {
+        std::shared_ptr<Tilemap> tilemap = std::make_shared<Tilemap>();
+        luabridge::push(luaState, tilemap.get());
+        luabridge::LuaRef component = luabridge::LuaRef::fromStack(luaState, -1);
 
-    if (it == components.end()) {
-        std::string filePath = componentFolderPath + componentName + ".lua";
+        tilemaps.push_back(std::pair(component, tilemap));
+        tilemap->key = componentKey;
 
-        if (!std::filesystem::exists(filePath)) {
-            std::cout << "error: failed to locate component " << componentName;
-            exit(0);
-        }
+        components.insert(std::pair(componentName, component));
+        return component;
+    }
 
-        // Load component and check if it is a valid lua file
-        if (luaL_dofile(luaState, filePath.c_str()) != 0) {
-            const char* lua_error_msg = lua_tostring(luaState, -1); // Get error message from top of Lua stack
-            std::cerr << "\033[31m" << "Error in Lua file '" << componentName << "': " << lua_error_msg << "\033[0m" << std::endl;
-            exit(0);
-        }
+    if (componentName == "ParticleEmitter") {
+        std::shared_ptr<ParticleEmitter> emitter = std::make_shared<ParticleEmitter>();
+        luabridge::push(luaState, emitter.get());
+        luabridge::LuaRef component = luabridge::LuaRef::fromStack(luaState, -1);
+
+        particleEmitters.push_back(std::pair(component, emitter));
+        emitter->key = componentKey;
+
+        components.insert(std::pair(componentName, component));
+        return component;
+    }
+
+    if (componentName == "Transform") {
+        std::shared_ptr<Transform> transform = std::make_shared<Transform>();
+        luabridge::push(luaState, transform.get());
+        luabridge::LuaRef component = luabridge::LuaRef::fromStack(luaState, -1);
+
+        transforms.push_back(std::pair(component, transform));
+        transform->key = componentKey;
 
-        luabridge::LuaRef component = luabridge::getGlobal(luaState, componentName.c_str());
-        component["type"] = componentName;
-        component["enabled"] = true;
         components.insert(std::pair(componentName, component));
-        it = components.find(componentName);
+        return component;
     }
 
-    luabridge::LuaRef parentScript = it->second;
+    // Load Lua Components
+    luabridge::LuaRef parentScript = LoadComponentType(componentName);
     luabridge::LuaRef instanceScript = luabridge::newTable(luaState);
     EstablishInheritance(instanceScript, parentScript);
 
@@ -80,30 +148,49 @@ luabridge::LuaRef ComponentManager::LoadComponentRuntime(const std::string& comp
         return component;
     }
 
-    auto it = components.find(componentName);
+    if (componentName == "Tilemap") {
+        std::shared_ptr<Tilemap> tilemap = std::make_shared<Tilemap>();
+        luabridge::push(luaState, tilemap.get());
+        luabridge::LuaRef component = luabridge::LuaRef::fromStack(luaState, -1);
 
-    if (it == components.end()) {
-        std::string filePath = componentFolderPath + componentName + ".lua";
+        tilemaps.push_back(std::pair(component, tilemap));
 
-        if (!std::filesystem::exists(filePath)) {
-            std::cout << "error: failed to locate component " << componentName;
-            exit(0);
-        }
+        tilemap->key = componentKey;
+        tilemap->enabled = false;
 
-        // Load component and check if it is a valid lua file
-        if (luaL_dofile(luaState, filePath.c_str()) != 0) {
-            std::cout << "problem with lua file " << componentName;
-            exit(0);
-        }
+        components.insert(std::pair(componentName, component));
+        return component;
+    }
+
+    if (componentName == "ParticleEmitter") {
+        std::shared_ptr<ParticleEmitter> emitter = std::make_shared<ParticleEmitter>();
+        luabridge::push(luaState, emitter.get());
+        luabridge::LuaRef component = luabridge::LuaRef::fromStack(luaState, -1);
+
+        particleEmitters.push_back(std::pair(component, emitter));
+
+        emitter->key = componentKey;
+        emitter->enabled = false;
 
-        luabridge::LuaRef component = luabridge::getGlobal(luaState, componentName.c_str());
-        component["type"] = componentName;
-        component["enabled"] = true;
         components.insert(std::pair(componentName, component));
-        it = components.find(componentName);
+        return component;
     }
 
-    luabridge::LuaRef parentScript = it->second;
+    if (componentName == "Transform") {
+        std::shared_ptr<Transform> transform = std::make_shared<Transform>();
+        luabridge::push(luaState, transform.get());
+        luabridge::LuaRef component = luabridge::LuaRef::fromStack(luaState, -1);
+
+        transforms.push_back(std::pair(component, transform));
+
+        transform->key = componentKey;
+        transform->enabled = false;
+
+        components.insert(std::pair(componentName, component));
+        return component;
+    }
+
+    luabridge::LuaRef parentScript = LoadComponentType(componentName);
     luabridge::LuaRef instanceScript = luabridge::newTable(luaState);
     EstablishInheritance(instanceScript, parentScript);
 
@@ -115,24 +202,182 @@ luabridge::LuaRef ComponentManager::LoadComponentRuntime(const std::string& comp
 }
 
 void ComponentManager::EstablishInheritance(luabridge::LuaRef instanceTable, luabridge::LuaRef parentTable) {
+    // Lookups go instance -> enabledTable -> parent. "enabled" is never stored on the instance itself,
+    // so every write to it reaches __newindex and the engine never has to read it back from Lua.
+    luabridge::LuaRef enabledTable = luabridge::newTable(luaState);
+    luabridge::LuaRef enabledMetatable = luabridge::newTable(luaState);
+    enabledMetatable["__index"] = parentTable;
+
+    enabledTable.push(luaState);
+    enabledMetatable.push(luaState);
+    lua_setmetatable(luaState, -2);
+    lua_pop(luaState, 1);
+
+    luabridge::LuaRef inheritedEnabled = parentTable["enabled"];
+    bool enabled = inheritedEnabled.isNil() || inheritedEnabled.cast<bool>();
+    enabledTable["enabled"].rawset(enabled);
+
     luabridge::LuaRef newMetatable = luabridge::newTable(luaState);
-    newMetatable["__index"] = parentTable;
+    newMetatable["__index"] = enabledTable;
 
-    instanceTable.push(luaState);
     newMetatable.push(luaState);
+    ComponentState* state = static_cast<ComponentState*>(lua_newuserdatauv(luaState, sizeof(ComponentState), 0));
+    state->enabled = enabled;
+    lua_pushvalue(luaState, -1);
+    lua_setfield(luaState, -3, "__state");
+    enabledTable.push(luaState);
+    lua_pushcclosure(luaState, ComponentNewIndex, 2);
+    lua_setfield(luaState, -2, "__newindex");
+
+    instanceTable.push(luaState);
+    lua_pushvalue(luaState, -2);
     lua_setmetatable(luaState, -2);
-    lua_pop(luaState, 1);
+    lua_pop(luaState, 2);
 }
 
-luabridge::LuaRef ComponentManager::CreateNewRigidbody(luabridge::LuaRef originalRigidbodyComponent, Actor* actorPtr) {
-    std::shared_ptr<Rigidbody> originalRb;
+bool* ComponentManager::GetEnabledFlag(luabridge::LuaRef component) {
+    // C++ components keep the flag as a member
+    if (component.isUserdata()) {
+        std::string type = component["type"].tostring();
+        if (type == "Tilemap")
+            return &component.cast<Tilemap*>()->enabled;
+        if (type == "ParticleEmitter")
+            return &component.cast<ParticleEmitter*>()->enabled;
+        if (type == "Transform")
+            return &component.cast<Transform*>()->enabled;
+        return &component.cast<Rigidbody*>()->enabled;
+    }
+
+    component.push(luaState);
+    if (!lua_getmetatable(luaState, -1)) {
+        lua_pop(luaState, 1);
+        return nullptr;
+    }
 
-    for (const auto& pair : rigidbodys) {
-        if (pair.first == originalRigidbodyComponent) {
-            originalRb = pair.second;
+    lua_getfield(luaState, -1, "__state");
+    ComponentState* state = static_cast<ComponentState*>(lua_touserdata(luaState, -1));
+    lua_pop(luaState, 3);
+
+    return state == nullptr ? nullptr : &state->enabled;
+}
+
+// Native components are reset by copying every setting from the template's instance. Anything the copy
+// would drop without freeing (bodies, chunks) has to be released before this runs.
+template <typename T>
+static void ResetNativeComponent(T* component, const T* templateComponent) {
+    Actor* actor = component->actor;
+    *component = *templateComponent;
+    component->actor = actor;
+}
+
+// Returns a pooled component to its template's state. The type's OnReset(self) runs first, while the
+// instance still has its fields and actor, then every field written on it is dropped so reads fall
+// through to the template again.
+void ComponentManager::ResetComponent(luabridge::LuaRef component, luabridge::LuaRef templateComponent) {
+    if (component.isUserdata()) {
+        std::string type = component["type"].tostring();
+        // OnDestroy is safe to run twice, and not every actor reaching the pool had it run
+        if (type == "Tilemap") {
+            Tilemap* tilemap = component.cast<Tilemap*>();
+            tilemap->OnDestroy();
+            ResetNativeComponent(tilemap, templateComponent.cast<Tilemap*>());
+        }
+        else if (type == "ParticleEmitter")
+            ResetNativeComponent(component.cast<ParticleEmitter*>(), templateComponent.cast<ParticleEmitter*>());
+        else if (type == "Transform")
+            ResetNativeComponent(component.cast<Transform*>(), templateComponent.cast<Transform*>());
+        else {
+            Rigidbody* rigidbody = component.cast<Rigidbody*>();
+            rigidbody->OnDestroy();
+            ResetNativeComponent(rigidbody, templateComponent.cast<Rigidbody*>());
         }
+        return;
     }
 
+    luabridge::LuaRef onReset = component["OnReset"];
+    if (onReset.isFunction()) {
+        try {
+            onReset(component);
+        }
+        catch (luabridge::LuaException e) {
+            std::string errorMessage = e.what();
+            std::replace(std::begin(errorMessage), std::end(errorMessage), '\\', '/');
+            std::cout << "\033[31m" << component["type"].tostring() << " : " << errorMessage << "\033[0m" << std::endl;
+        }
+    }
+
+    // Clearing fields that already exist is allowed during lua_next
+    component.push(luaState);
+    lua_pushnil(luaState);
+    while (lua_next(luaState, -2) != 0) {
+        lua_pop(luaState, 1);
+        lua_pushvalue(luaState, -1);
+        lua_pushnil(luaState);
+        lua_rawset(luaState, -4);
+    }
+    lua_pop(luaState, 1);
+
+    luabridge::LuaRef templateEnabled = templateComponent["enabled"];
+    component["enabled"] = templateEnabled;
+}
+
+// Native OnDestroy functions are all safe to run twice, so this is fine to call on an actor whose OnDestroy already ran
+void ComponentManager::ReleaseNativeComponent(luabridge::LuaRef component) {
+    if (!component.isUserdata())
+        return;
+
+    std::string type = component["type"].tostring();
+    if (type == "Tilemap")
+        component.cast<Tilemap*>()->OnDestroy();
+    else if (type == "Transform")
+        component.cast<Transform*>()->OnDestroy();
+    else if (type == "Rigidbody")
+        component.cast<Rigidbody*>()->OnDestroy();
+}
+
+// Reads one compiled override and assigns it to the component. Keys and string values are interned
+// per asset, so this is a plain lua_settable with nothing converted or allocated on the way.
+void ComponentManager::ApplyOverride(luabridge::LuaRef component, CompiledAsset& asset, AssetReader& reader) {
+    uint32_t memberName = reader.ReadUInt();
+    uint8_t valueType = reader.ReadByte();
+
+    // Tile layers are the only array members, they go straight to the native component
+    if (valueType == COMPILED_INT_ARRAY) {
+        if (asset.GetString(memberName) == "tiles" && component.isUserdata() && component["type"].tostring() == "Tilemap")
+            reader.ReadInts(component.cast<Tilemap*>()->tiles);
+        else
+            reader.SkipInts();
+        return;
+    }
+
+    component.push(luaState);
+    asset.GetLuaString(luaState, memberName).push(luaState);
+
+    switch (valueType) {
+    case COMPILED_STRING:
+        asset.GetLuaString(luaState, reader.ReadUInt()).push(luaState);
+        break;
+    case COMPILED_INT:
+        lua_pushinteger(luaState, reader.ReadInt());
+        break;
+    case COMPILED_DOUBLE:
+        lua_pushnumber(luaState, reader.ReadDouble());
+        break;
+    case COMPILED_BOOL:
+        lua_pushboolean(luaState, reader.ReadByte());
+        break;
+    default:
+        std::cout << "error: unknown override type in compiled asset";
+        exit(0);
+    }
+
+    lua_settable(luaState, -3);
+    lua_pop(luaState, 1);
+}
+
+luabridge::LuaRef ComponentManager::CreateNewRigidbody(luabridge::LuaRef originalRigidbodyComponent, Actor* actorPtr) {
+    Rigidbody* originalRb = originalRigidbodyComponent.cast<Rigidbody*>();
+
     std::shared_ptr<Rigidbody> newRb = originalRb->Clone(actorPtr);
 
     luabridge::push(luaState, newRb.get());
@@ -145,6 +390,51 @@ luabridge::LuaRef ComponentManager::CreateNewRigidbody(luabridge::LuaRef origina
     return component;
 }
 
+luabridge::LuaRef ComponentManager::CreateNewTilemap(luabridge::LuaRef originalTilemapComponent, Actor* actorPtr) {
+    Tilemap* originalTilemap = originalTilemapComponent.cast<Tilemap*>();
+
+    std::shared_ptr<Tilemap> newTilemap = originalTilemap->Clone(actorPtr);
+
+    luabridge::push(luaState, newTilemap.get());
+    luabridge::LuaRef component = luabridge::LuaRef::fromStack(luaState, -1);
+
+    tilemaps.push_back(std::pair(component, newTilemap));
+
+    components.insert(std::pair(originalTilemapComponent["type"].tostring(), component));
+
+    return component;
+}
+
+luabridge::LuaRef ComponentManager::CreateNewParticleEmitter(luabridge::LuaRef originalEmitterComponent, Actor* actorPtr) {
+    ParticleEmitter* originalEmitter = originalEmitterComponent.cast<ParticleEmitter*>();
+
+    std::shared_ptr<ParticleEmitter> newEmitter = originalEmitter->Clone(actorPtr);
+
+    luabridge::push(luaState, newEmitter.get());
+    luabridge::LuaRef component = luabridge::LuaRef::fromStack(luaState, -1);
+
+    particleEmitters.push_back(std::pair(component, newEmitter));
+
+    components.insert(std::pair(originalEmitterComponent["type"].tostring(), component));
+
+    return component;
+}
+
+luabridge::LuaRef ComponentManager::CreateNewTransform(luabridge::LuaRef originalTransformComponent, Actor* actorPtr) {
+    Transform* originalTransform = originalTransformComponent.cast<Transform*>();
+
+    std::shared_ptr<Transform> newTransform = originalTransform->Clone(actorPtr);
+
+    luabridge::push(luaState, newTransform.get());
+    luabridge::LuaRef component = luabridge::LuaRef::fromStack(luaState, -1);
+
+    transforms.push_back(std::pair(component, newTransform));
+
+    components.insert(std::pair(originalTransformComponent["type"].tostring(), component));
+
+    return component;
+}
+
 void ComponentManager::SetState(lua_State* s) {
     luaState = s;
 }
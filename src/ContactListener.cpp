@@ -1,220 +1,140 @@
 #include "ContactListener.h"
+#include "SceneManager.h"
+#include <algorithm>
+#include <tuple>
 
 
+ContactListener::ContactListener() {
+	events.reserve(256);
+	dispatchingEvents.reserve(256);
+}
+
+size_t ContactListener::ActorPairHash::operator()(const ActorPair& pair) const {
+	uint64_t first = (static_cast<uint64_t>(pair.first.slot) << 32) | pair.first.generation;
+	uint64_t second = (static_cast<uint64_t>(pair.second.slot) << 32) | pair.second.generation;
+	return std::hash<uint64_t>()(first * 1099511628211ull ^ second) ^ pair.triggers;
+}
+
 void ContactListener::BeginContact(b2Contact* contact) {
+	RecordContact(contact, true);
+}
+
+void ContactListener::EndContact(b2Contact* contact) {
+	RecordContact(contact, false);
+}
+
+void ContactListener::RecordContact(b2Contact* contact, bool begin) {
 	b2Fixture* fixtureA = contact->GetFixtureA();
 	b2Fixture* fixtureB = contact->GetFixtureB();
 
+	// Collisions need two colliders and triggers two triggers, a collider touching a trigger is neither
+	bool triggers = fixtureA->IsSensor();
+	if (fixtureB->IsSensor() != triggers)
+		return;
+
 	Actor* actorA = reinterpret_cast<Actor*>(fixtureA->GetUserData().pointer);
 	Actor* actorB = reinterpret_cast<Actor*>(fixtureB->GetUserData().pointer);
+	if (actorA == nullptr || actorB == nullptr)
+		return;
 
-	b2WorldManifold manifold;
-	contact->GetWorldManifold(&manifold);
-
-	Collision collision;
-
-	collision.relative_velocity = fixtureA->GetBody()->GetLinearVelocity() - fixtureB->GetBody()->GetLinearVelocity();
-	// Collisions
-	if (!fixtureA->IsSensor() && !fixtureB->IsSensor()) {
-		std::map<std::string, luabridge::LuaRef>& onCollisionEnterComponents = actorA->onCollisionEnterComponents;
-		collision.other = actorB;
-		collision.point = manifold.points[0];
-		collision.normal = manifold.normal;
-		for (auto& pair : onCollisionEnterComponents) {
-			// If the actor gets disabled, don't finish running its components
-			if (actorA->enabled == false)
-				break;
-
-			luabridge::LuaRef component = pair.second;
-
-			if (component["enabled"] == false)
-				continue;
-			try {
-				component["OnCollisionEnter"](component, collision);
-			}
-			catch (luabridge::LuaException e) {
-				std::string errorMessage = e.what();
-				std::replace(std::begin(errorMessage), std::end(errorMessage), '\\', '/');
-				std::cout << "\033[31m" << actorA->GetName() << " : " << errorMessage << "\033[0m" << std::endl;
-			}
-		}
-
-		onCollisionEnterComponents = actorB->onCollisionEnterComponents;
-		collision.other = actorA;
-		for (auto& pair : onCollisionEnterComponents) {
-			// If the actor gets disabled, don't finish running its components
-			if (actorB->enabled == false)
-				break;
+	ContactEvent event;
+	event.actorA = actorA->GetHandle();
+	event.actorB = actorB->GetHandle();
 
-			luabridge::LuaRef component = pair.second;
+	// Box2D doesn't keep the same fixture order for every pair, so the key does
+	ActorPair pair = { event.actorA, event.actorB, triggers };
+	if (std::tie(pair.second.slot, pair.second.generation) < std::tie(pair.first.slot, pair.first.generation))
+		std::swap(pair.first, pair.second);
 
-			if (component["enabled"] == false)
-				continue;
-			try {
-				component["OnCollisionEnter"](component, collision);
-			}
-			catch (luabridge::LuaException e) {
-				std::string errorMessage = e.what();
-				std::replace(std::begin(errorMessage), std::end(errorMessage), '\\', '/');
-				std::cout << "\033[31m" << actorB->GetName() << " : " << errorMessage << "\033[0m" << std::endl;
-			}
-		}
+	if (begin) {
+		if (++touchingFixturePairs[pair] > 1)
+			return;
+	}
+	else {
+		auto it = touchingFixturePairs.find(pair);
+		if (it == std::end(touchingFixturePairs) || --it->second > 0)
+			return;
+		touchingFixturePairs.erase(it);
 	}
 
-	// Triggers
-	else if (fixtureA->IsSensor() && fixtureB->IsSensor()) {
-		collision.point = b2Vec2(-999.0f, -999.0f);
-		collision.normal = b2Vec2(-999.0f, -999.0f);
-		std::map<std::string, luabridge::LuaRef>& onTriggerEnterComponents = actorA->onTriggerEnterComponents;
-		collision.other = actorB;
-		for (auto& pair : onTriggerEnterComponents) {
-			// If the actor gets disabled, don't finish running its components
-			if (actorA->enabled == false)
-				break;
-
-			luabridge::LuaRef component = pair.second;
-
-			if (component["enabled"] == false)
-				continue;
-			try {
-				component["OnTriggerEnter"](component, collision);
-			}
-			catch (luabridge::LuaException e) {
-				std::string errorMessage = e.what();
-				std::replace(std::begin(errorMessage), std::end(errorMessage), '\\', '/');
-				std::cout << "\033[31m" << actorA->GetName() << " : " << errorMessage << "\033[0m" << std::endl;
-			}
-		}
-
-		onTriggerEnterComponents = actorB->onTriggerEnterComponents;
-		collision.other = actorA;
-		for (auto& pair : onTriggerEnterComponents) {
-			// If the actor gets disabled, don't finish running its components
-			if (actorB->enabled == false)
-				break;
-
-			luabridge::LuaRef component = pair.second;
+	event.relativeVelocity = fixtureA->GetBody()->GetLinearVelocity() - fixtureB->GetBody()->GetLinearVelocity();
+	event.point = b2Vec2(-999.0f, -999.0f);
+	event.normal = b2Vec2(-999.0f, -999.0f);
 
-			if (component["enabled"] == false)
-				continue;
-			try {
-				component["OnTriggerEnter"](component, collision);
-			}
-			catch (luabridge::LuaException e) {
-				std::string errorMessage = e.what();
-				std::replace(std::begin(errorMessage), std::end(errorMessage), '\\', '/');
-				std::cout << "\033[31m" << actorB->GetName() << " : " << errorMessage << "\033[0m" << std::endl;
-			}
+	if (triggers) {
+		event.type = begin ? TRIGGER_ENTER : TRIGGER_EXIT;
+	}
+	else {
+		event.type = begin ? COLLISION_ENTER : COLLISION_EXIT;
+
+		if (begin) {
+			b2WorldManifold manifold;
+			contact->GetWorldManifold(&manifold);
+			event.point = manifold.points[0];
+			event.normal = manifold.normal;
 		}
 	}
+
+	events.push_back(event);
 }
 
-void ContactListener::EndContact(b2Contact* contact) {
-	b2Fixture* fixtureA = contact->GetFixtureA();
-	b2Fixture* fixtureB = contact->GetFixtureB();
+void ContactListener::DispatchEvents() {
+	dispatchingEvents.swap(events);
 
-	Actor* actorA = reinterpret_cast<Actor*>(fixtureA->GetUserData().pointer);
-	Actor* actorB = reinterpret_cast<Actor*>(fixtureB->GetUserData().pointer);
+	for (const ContactEvent& event : dispatchingEvents) {
+		// Either actor may have been destroyed since, its half of the event is dropped
+		Actor* actorA = SceneManager::ResolveActor(event.actorA);
+		Actor* actorB = SceneManager::ResolveActor(event.actorB);
 
-	b2WorldManifold manifold;
-	contact->GetWorldManifold(&manifold);
+		Collision collision;
+		collision.point = event.point;
+		collision.relative_velocity = event.relativeVelocity;
+		collision.normal = event.normal;
 
-	Collision collision;
-	collision.relative_velocity = fixtureA->GetBody()->GetLinearVelocity() - fixtureB->GetBody()->GetLinearVelocity();
+		for (int side = 0; side < 2; side++) {
+			Actor* actor = side == 0 ? actorA : actorB;
+			if (actor == nullptr)
+				continue;
 
-	// Collisions
-	if (!fixtureA->IsSensor() && !fixtureB->IsSensor()) {
-		collision.other = actorB;
-		collision.point = b2Vec2(-999.0f, -999.0f);
-		collision.normal = b2Vec2(-999.0f, -999.0f);
-		std::map<std::string, luabridge::LuaRef>& onCollisionExitComponents = actorA->onCollisionExitComponents;
+			collision.other = side == 0 ? event.actorB : event.actorA;
 
-		for (auto& pair : onCollisionExitComponents) {
-			// If the actor gets disabled, don't finish running its components
-			if (actorA->enabled == false)
+			switch (event.type) {
+			case COLLISION_ENTER:
+				CallHandlers(actor, actor->onCollisionEnterComponents, "OnCollisionEnter", collision);
 				break;
-
-			luabridge::LuaRef component = pair.second;
-
-			if (component["enabled"] == false)
-				continue;
-			try {
-				component["OnCollisionExit"](component, collision);
-			}
-			catch (luabridge::LuaException e) {
-				std::string errorMessage = e.what();
-				std::replace(std::begin(errorMessage), std::end(errorMessage), '\\', '/');
-				std::cout << "\033[31m" << actorA->GetName() << " : " << errorMessage << "\033[0m" << std::endl;
-			}
-		}
-
-		onCollisionExitComponents = actorB->onCollisionExitComponents;
-		collision.other = actorA;
-		for (auto& pair : onCollisionExitComponents) {
-			// If the actor gets disabled, don't finish running its components
-			if (actorB->enabled == false)
+			case COLLISION_EXIT:
+				CallHandlers(actor, actor->onCollisionExitComponents, "OnCollisionExit", collision);
+				break;
+			case TRIGGER_ENTER:
+				CallHandlers(actor, actor->onTriggerEnterComponents, "OnTriggerEnter", collision);
+				break;
+			case TRIGGER_EXIT:
+				CallHandlers(actor, actor->onTriggerExitComponents, "OnTriggerExit", collision);
 				break;
-
-			luabridge::LuaRef component = pair.second;
-
-			if (component["enabled"] == false)
-				continue;
-			try {
-				component["OnCollisionExit"](component, collision);
-			}
-			catch (luabridge::LuaException e) {
-				std::string errorMessage = e.what();
-				std::replace(std::begin(errorMessage), std::end(errorMessage), '\\', '/');
-				std::cout << "\033[31m" << actorB->GetName() << " : " << errorMessage << "\033[0m" << std::endl;
 			}
 		}
 	}
 
-	// Triggers
-	else if (fixtureA->IsSensor() && fixtureB->IsSensor()) {
-		collision.point = b2Vec2(-999.0f, -999.0f);
-		collision.normal = b2Vec2(-999.0f, -999.0f);
-		std::map<std::string, luabridge::LuaRef>& onTriggerExitComponents = actorA->onTriggerExitComponents;
-		collision.other = actorB;
-		for (auto& pair : onTriggerExitComponents) {
-			// If the actor gets disabled, don't finish running its components
-			if (actorA->enabled == false)
-				break;
-
-			luabridge::LuaRef component = pair.second;
-
-			if (component["enabled"] == false)
-				continue;
-			try {
-				component["OnTriggerExit"](component, collision);
-			}
-			catch (luabridge::LuaException e) {
-				std::string errorMessage = e.what();
-				std::replace(std::begin(errorMessage), std::end(errorMessage), '\\', '/');
-				std::cout << "\033[31m" << actorA->GetName() << " : " << errorMessage << "\033[0m" << std::endl;
-			}
-		}
+	dispatchingEvents.clear();
+}
 
-		onTriggerExitComponents = actorB->onTriggerExitComponents;
-		collision.other = actorA;
-		for (auto& pair : onTriggerExitComponents) {
-			// If the actor gets disabled, don't finish running its components
-			if (actorB->enabled == false)
-				break;
+void ContactListener::CallHandlers(Actor* actor, std::map<std::string, luabridge::LuaRef>& handlers, const char* functionName, const Collision& collision) {
+	for (auto& pair : handlers) {
+		// If the actor gets disabled, don't finish running its components
+		if (actor->enabled == false)
+			break;
 
-			luabridge::LuaRef component = pair.second;
+		luabridge::LuaRef component = pair.second;
 
-			if (component["enabled"] == false)
-				continue;
-			try {
-				component["OnTriggerExit"](component, collision);
-			}
-			catch (luabridge::LuaException e) {
-				std::string errorMessage = e.what();
-				std::replace(std::begin(errorMessage), std::end(errorMessage), '\\', '/');
-				std::cout << "\033[31m" << actorB->GetName() << " : " << errorMessage << "\033[0m" << std::endl;
-			}
+		if (component["enabled"] == false)
+			continue;
+		try {
+			component[functionName](component, collision);
+		}
+		catch (luabridge::LuaException e) {
+			std::string errorMessage = e.what();
+			std::replace(std::begin(errorMessage), std::end(errorMessage), '\\', '/');
+			std::cout << "\033[31m" << actor->GetName() << " : " << errorMessage << "\033[0m" << std::endl;
 		}
 	}
-
-}
\ No newline at end of file
+}
@@ -9,15 +9,61 @@
 #include "ReadJsonFile.h"
 #include "SceneManager.h"
 #include "SDL2/SDL_scancode.h"
+#include <algorithm>
 #include <iostream>
 #include <TextManager.h>
 #include <thread>
 #include "Rigidbody.h"
 #include "RayCast.h"
 #include "EventBus.h"
+#include "Profiler.h"
+#include "AssetCache.h"
+#include "LuaAllocator.h"
 
 
-GameEngine::GameEngine() : running(true), window(nullptr), renderer(nullptr) {}
+GameEngine::GameEngine() : running(true), window(nullptr), renderer(nullptr), headlessSurface(nullptr) {}
+
+// Supported flags:
+//   --headless          no window or vsync, draws go to an offscreen software renderer
+//   --frames <n>        quit after n frames
+//   --delta-time <s>    simulate every frame as taking s seconds (defaults to 1/60 when headless)
+//   --compile-assets    compile every scene, template and component type into resources/.cache and quit
+void GameEngine::ParseCommandLine(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg == "--headless") {
+            headless = true;
+        }
+        else if (arg == "--frames" && i + 1 < argc) {
+            frameLimit = std::atoi(argv[++i]);
+        }
+        else if (arg == "--delta-time" && i + 1 < argc) {
+            fixedDeltaTime = static_cast<float>(std::atof(argv[++i]));
+        }
+        else if (arg == "--compile-assets") {
+            AssetCache::CompileAll();
+            exit(0);
+        }
+        else {
+            std::cout << "warning: unknown argument " << arg << std::endl;
+        }
+    }
+
+    if (headless) {
+        if (fixedDeltaTime <= 0.0f)
+            fixedDeltaTime = 1.0f / 60.0f;
+
+        // Keep SDL away from the display and sound card so this runs on CI machines
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+        SDL_SetHint(SDL_HINT_AUDIODRIVER, "dummy");
+
+        // Report on every exit path, including Application.Quit(). Handlers run in reverse, frame timings come first.
+        Profiler::SetEnabled(true);
+        std::atexit(LuaAllocator::PrintReport);
+        std::atexit(Profiler::PrintReport);
+    }
+}
 
 void GameEngine::Initialize() {
     Input::Init();
@@ -35,10 +81,24 @@ void GameEngine::Initialize() {
     lastFrameTime = std::chrono::high_resolution_clock::now();
 }
 
+// lua_newstate leaves out the panic handler luaL_newstate would have installed
+static int LuaPanic(lua_State* L) {
+    const char* message = lua_tostring(L, -1);
+    std::cout << "error: unprotected Lua error: " << (message != nullptr ? message : "(no message)") << std::endl;
+    exit(0);
+}
+
 void GameEngine::InitializeLua() {
-    luaState = luaL_newstate();
+    luaState = lua_newstate(&LuaAllocator::Allocate, nullptr);
+    lua_atpanic(luaState, &LuaPanic);
     luaL_openlibs(luaState);
 
+    // Incremental mode, stepped only by CollectLuaGarbage. Its basic steps are small and can stop anywhere in a cycle, so
+    // the collection fits in the time a frame has left. A generational step can't be split, and once the old generation
+    // has grown it is a whole major collection.
+    lua_gc(luaState, LUA_GCINC, 0, 0, 0);
+    lua_gc(luaState, LUA_GCSTOP);
+
     SceneManager::SetLuaState(luaState);
     ComponentManager::SetState(luaState);
     Actor::SetLuaState(luaState);
@@ -53,14 +113,16 @@ void GameEngine::InitializeLua() {
 
     // Actor API
     luabridge::getGlobalNamespace(luaState)
-        .beginClass<Actor>("Actor")
-        .addFunction("GetName", &Actor::GetName)
-        .addFunction("GetID", &Actor::GetID)
-        .addFunction("GetComponentByKey", &Actor::GetComponentByKey)
-        .addFunction("GetComponent", &Actor::GetComponent)
-        .addFunction("GetComponents", &Actor::GetComponents)
-        .addFunction("AddComponent", &Actor::AddComponent)
-        .addFunction("RemoveComponent", &Actor::RemoveComponent)
+        .beginClass<ActorHandle>("Actor")
+        .addFunction("IsValid", &ActorHandle::IsValid)
+        .addFunction("GetName", &ActorHandle::GetName)
+        .addFunction("GetID", &ActorHandle::GetID)
+        .addFunction("GetComponentByKey", &ActorHandle::GetComponentByKey)
+        .addFunction("GetComponent", &ActorHandle::GetComponent)
+        .addFunction("GetComponents", &ActorHandle::GetComponents)
+        .addFunction("AddComponent", &ActorHandle::AddComponent)
+        .addFunction("RemoveComponent", &ActorHandle::RemoveComponent)
+        .addFunction("__eq", &ActorHandle::operator==)
         .endClass();
 
     luabridge::getGlobalNamespace(luaState)
@@ -84,6 +146,7 @@ void GameEngine::InitializeLua() {
         .beginNamespace("Time")
         .addFunction("GetCurrent", &GameEngine::ApplicationTime)
         .addVariable("deltaTime", &GameEngine::deltaTime, false)
+        .addVariable("fixedDeltaTime", &GameEngine::timeStep, false)
         .endNamespace();
 
     luabridge::getGlobalNamespace(luaState)
@@ -127,10 +190,12 @@ void GameEngine::InitializeLua() {
     // Image Scripting API
     luabridge::getGlobalNamespace(luaState)
         .beginNamespace("Image")
-        .addFunction("DrawUI", &ImageManager::SubmitUIDrawRequest)
-        .addFunction("DrawUIEx", &ImageManager::SubmitUIExDrawRequest)
-        .addFunction("Draw", &ImageManager::SubmitScreenSpaceDrawRequest)
-        .addFunction("DrawEx", &ImageManager::SubmitScreenSpaceExDrawRequest)
+        .addFunction("Load", &ImageManager::LuaLoad)
+        .addFunction("DrawUI", &ImageManager::LuaDrawUI)
+        .addFunction("DrawUIEx", &ImageManager::LuaDrawUIEx)
+        .addFunction("Draw", &ImageManager::LuaDraw)
+        .addFunction("DrawEx", &ImageManager::LuaDrawEx)
+        .addFunction("GetDrawStats", &ImageManager::LuaGetDrawStats)
         .addFunction("DrawPixel", &ImageManager::SubmitPixelDrawRequest)
         .endNamespace();
 
@@ -152,6 +217,8 @@ void GameEngine::InitializeLua() {
         .addFunction("Load", &SceneManager::LoadSceneRuntime)
         .addFunction("GetCurrent", &SceneManager::GetCurrentSceneName)
         .addFunction("DontDestroy", &SceneManager::DontDestroy)
+        .addFunction("IsLoading", &SceneManager::IsLoading)
+        .addFunction("GetLoadProgress", &SceneManager::GetLoadProgress)
         .endNamespace();
 
     // Physics API
@@ -165,6 +232,11 @@ void GameEngine::InitializeLua() {
         .addFunction("__add", &b2Vec2::operator_add)
         .addFunction("__sub", &b2Vec2::operator_sub)
         .addFunction("__mul", &b2Vec2::operator_mul)
+        .addFunction("Set", &b2Vec2::Set)
+        .addFunction("Add", &b2Vec2::Add)
+        .addFunction("Sub", &b2Vec2::Sub)
+        .addFunction("Scale", &b2Vec2::Scale)
+        .addFunction("LengthSquared", &b2Vec2::LengthSquared)
         .addStaticFunction("Distance", &b2Distance)
         .addStaticFunction("Dot", static_cast<float (*)(const b2Vec2&, const b2Vec2&)>(&b2Dot))
         .endClass();
@@ -173,6 +245,8 @@ void GameEngine::InitializeLua() {
         .beginClass<Rigidbody>("Rigidbody")
         .addFunction("GetPosition", &Rigidbody::GetPosition)
         .addFunction("GetRotation", &Rigidbody::GetRotation)
+        .addFunction("GetInterpolatedPosition", &Rigidbody::GetInterpolatedPosition)
+        .addFunction("GetInterpolatedRotation", &Rigidbody::GetInterpolatedRotation)
         .addFunction("AddForce", &Rigidbody::AddForce)
         .addFunction("SetVelocity", &Rigidbody::SetVelocity)
         .addFunction("SetPosition", &Rigidbody::SetPosition)
@@ -186,7 +260,14 @@ void GameEngine::InitializeLua() {
         .addFunction("GetUpDirection", &Rigidbody::GetUpDirection)
         .addFunction("SetRightDirection", &Rigidbody::SetRightDirection)
         .addFunction("GetRightDirection", &Rigidbody::GetRightDirection)
+        .addFunction("GetPositionXY", &Rigidbody::GetPositionXY)
+        .addFunction("GetInterpolatedPositionXY", &Rigidbody::GetInterpolatedPositionXY)
+        .addFunction("GetVelocityXY", &Rigidbody::GetVelocityXY)
+        .addFunction("SetPositionXY", &Rigidbody::SetPositionXY)
+        .addFunction("SetVelocityXY", &Rigidbody::SetVelocityXY)
+        .addFunction("AddForceXY", &Rigidbody::AddForceXY)
         .addFunction("OnStart", &Rigidbody::OnStart)
+        .addFunction("OnDestroy", &Rigidbody::OnDestroy)
         .addProperty("actor", &Rigidbody::actor)
         .addProperty("enabled", &Rigidbody::enabled)
         .addProperty("key", &Rigidbody::key)
@@ -213,6 +294,90 @@ void GameEngine::InitializeLua() {
         .addProperty("bounciness", &Rigidbody::bounciness)
         .endClass();
 
+    luabridge::getGlobalNamespace(luaState)
+        .beginClass<Tilemap>("Tilemap")
+        .addFunction("GetTile", &Tilemap::GetTile)
+        .addFunction("GetChunkCount", &Tilemap::GetChunkCount)
+        .addFunction("OnStart", &Tilemap::OnStart)
+        .addFunction("OnUpdate", &Tilemap::OnUpdate)
+        .addFunction("OnDestroy", &Tilemap::OnDestroy)
+        .addProperty("actor", &Tilemap::actor)
+        .addProperty("enabled", &Tilemap::enabled)
+        .addProperty("key", &Tilemap::key)
+        .addProperty("type", &Tilemap::type)
+        .addProperty("tileset", &Tilemap::tileset)
+        .addProperty("tile_width", &Tilemap::tileWidth)
+        .addProperty("tile_height", &Tilemap::tileHeight)
+        .addProperty("columns", &Tilemap::columns)
+        .addProperty("rows", &Tilemap::rows)
+        .addProperty("chunk_size", &Tilemap::chunkSize)
+        .addProperty("x", &Tilemap::x)
+        .addProperty("y", &Tilemap::y)
+        .addProperty("sorting_order", &Tilemap::sortingOrder)
+        .addProperty("has_collider", &Tilemap::hasCollider)
+        .addProperty("friction", &Tilemap::friction)
+        .addProperty("bounciness", &Tilemap::bounciness)
+        .endClass();
+
+    luabridge::getGlobalNamespace(luaState)
+        .beginClass<ParticleEmitter>("ParticleEmitter")
+        .addFunction("Burst", &ParticleEmitter::Burst)
+        .addFunction("Clear", &ParticleEmitter::Clear)
+        .addFunction("GetParticleCount", &ParticleEmitter::GetParticleCount)
+        .addFunction("OnStart", &ParticleEmitter::OnStart)
+        .addFunction("OnUpdate", &ParticleEmitter::OnUpdate)
+        .addProperty("actor", &ParticleEmitter::actor)
+        .addProperty("enabled", &ParticleEmitter::enabled)
+        .addProperty("key", &ParticleEmitter::key)
+        .addProperty("type", &ParticleEmitter::type)
+        .addProperty("image", &ParticleEmitter::image)
+        .addProperty("x", &ParticleEmitter::x)
+        .addProperty("y", &ParticleEmitter::y)
+        .addProperty("emit_rate", &ParticleEmitter::emitRate)
+        .addProperty("max_particles", &ParticleEmitter::maxParticles)
+        .addProperty("lifetime", &ParticleEmitter::lifetime)
+        .addProperty("lifetime_variance", &ParticleEmitter::lifetimeVariance)
+        .addProperty("speed_min", &ParticleEmitter::speedMin)
+        .addProperty("speed_max", &ParticleEmitter::speedMax)
+        .addProperty("angle_min", &ParticleEmitter::angleMin)
+        .addProperty("angle_max", &ParticleEmitter::angleMax)
+        .addProperty("gravity_x", &ParticleEmitter::gravityX)
+        .addProperty("gravity_y", &ParticleEmitter::gravityY)
+        .addProperty("drag", &ParticleEmitter::drag)
+        .addProperty("start_scale", &ParticleEmitter::startScale)
+        .addProperty("end_scale", &ParticleEmitter::endScale)
+        .addProperty("start_color_r", &ParticleEmitter::startColorR)
+        .addProperty("start_color_g", &ParticleEmitter::startColorG)
+        .addProperty("start_color_b", &ParticleEmitter::startColorB)
+        .addProperty("start_color_a", &ParticleEmitter::startColorA)
+        .addProperty("end_color_r", &ParticleEmitter::endColorR)
+        .addProperty("end_color_g", &ParticleEmitter::endColorG)
+        .addProperty("end_color_b", &ParticleEmitter::endColorB)
+        .addProperty("end_color_a", &ParticleEmitter::endColorA)
+        .addProperty("sorting_order", &ParticleEmitter::sortingOrder)
+        .endClass();
+
+    luabridge::getGlobalNamespace(luaState)
+        .beginClass<Transform>("Transform")
+        .addFunction("GetPosition", &Transform::GetPosition)
+        .addFunction("SetPosition", &Transform::SetPosition)
+        .addFunction("GetWorldPosition", &Transform::GetWorldPosition)
+        .addFunction("GetWorldRotation", &Transform::GetWorldRotation)
+        .addFunction("GetWorldScale", &Transform::GetWorldScale)
+        .addFunction("SetParent", &Transform::SetParent)
+        .addFunction("GetParent", &Transform::GetParent)
+        .addFunction("OnDestroy", &Transform::OnDestroy)
+        .addProperty("actor", &Transform::actor)
+        .addProperty("enabled", &Transform::enabled)
+        .addProperty("key", &Transform::key)
+        .addProperty("type", &Transform::type)
+        .addProperty("x", &Transform::GetX, &Transform::SetX)
+        .addProperty("y", &Transform::GetY, &Transform::SetY)
+        .addProperty("rotation", &Transform::GetRotation, &Transform::SetRotation)
+        .addProperty("scale_x", &Transform::GetScaleX, &Transform::SetScaleX)
+        .addProperty("scale_y", &Transform::GetScaleY, &Transform::SetScaleY)
+        .endClass();
+
     luabridge::getGlobalNamespace(luaState)
         .beginClass<Collision>("Collision")
         .addProperty("other", &Collision::other)
@@ -250,6 +415,7 @@ void GameEngine::InitializeB2D() {
     contactListener = std::make_shared<ContactListener>();
     world->SetContactListener(contactListener.get());
     Rigidbody::SetWorld(world);
+    Tilemap::SetWorld(world);
     RayCast::SetPhysicsWorld(world);
 }
 
@@ -261,18 +427,39 @@ std::shared_ptr<b2World> GameEngine::GetPhysicsWorld() {
     return world;
 }
 
+float GameEngine::GetDeltaTime() {
+    return deltaTime;
+}
+
 void GameEngine::Run() {
+    int frameCount = 0;
+
     while (running) {
+        Profiler::BeginFrame();
+
         auto now = std::chrono::high_resolution_clock::now();
-        deltaTime = std::chrono::duration<float, std::chrono::seconds::period>(now - lastFrameTime).count();
+        if (fixedDeltaTime > 0.0f)
+            deltaTime = fixedDeltaTime;
+        else
+            deltaTime = std::chrono::duration<float, std::chrono::seconds::period>(now - lastFrameTime).count();
         lastFrameTime = now;
+
         ProcessInput();
         Update();
+        CollectLuaGarbage();
         Render();
+
+        Profiler::EndFrame();
+
+        frameCount++;
+        if (frameLimit > 0 && frameCount >= frameLimit)
+            running = false;
     }
 }
 
 void GameEngine::ProcessInput() {
+    ProfileScope profileScope(PROFILE_PROCESS_INPUT);
+
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
         Input::ProcessEvent(event);
@@ -284,24 +471,67 @@ void GameEngine::ProcessInput() {
 }
 
 void GameEngine::Update() {
-    if (SceneManager::loadingNewScene)
-        SceneManager::LoadScene(SceneManager::nextSceneName);
+    {
+        ProfileScope profileScope(PROFILE_LOAD_SCENE);
+        bool wasLoading = SceneManager::IsLoading();
+        if (SceneManager::loadingNewScene)
+            SceneManager::LoadSceneAsync(SceneManager::nextSceneName);
+        SceneManager::ContinueSceneLoad();
+        if (wasLoading && !SceneManager::IsLoading())
+            broadPhaseDirty = true;
+    }
 
-    SceneManager::RunOnStartLifecycleFunctions();
-    SceneManager::RunOnUpdateLifecycleFunctions();
-    SceneManager::RunOnLateUpdateLifecycleFunctions();
-    SceneManager::RunOnDestroyLifecycleFunctions();
+    {
+        ProfileScope profileScope(PROFILE_ON_START);
+        SceneManager::RunOnStartLifecycleFunctions();
+    }
+
+    // Bodies and tilemap colliders are created in OnStart, so the level is complete now
+    if (broadPhaseDirty) {
+        world->RebuildBroadPhase();
+        broadPhaseDirty = false;
+    }
+
+    {
+        ProfileScope profileScope(PROFILE_ON_UPDATE);
+        SceneManager::RunOnUpdateLifecycleFunctions();
+    }
+    {
+        ProfileScope profileScope(PROFILE_ON_LATE_UPDATE);
+        SceneManager::RunOnLateUpdateLifecycleFunctions();
+    }
+    {
+        ProfileScope profileScope(PROFILE_ON_DESTROY);
+        SceneManager::RunOnDestroyLifecycleFunctions();
+    }
     Input::LateUpdate();
 
-    SceneManager::UpdateAllActorComponents(); // Handles removing and adding of components on actors
-    SceneManager::ProcessActorQueues();
-    EventBus::HandleSubscriptionQueues();
+    {
+        ProfileScope profileScope(PROFILE_UPDATE_COMPONENTS);
+        SceneManager::UpdateAllActorComponents(); // Handles removing and adding of components on actors
+    }
+    {
+        ProfileScope profileScope(PROFILE_PROCESS_ACTOR_QUEUES);
+        SceneManager::ProcessActorQueues();
+    }
+    {
+        ProfileScope profileScope(PROFILE_EVENT_BUS);
+        EventBus::HandleSubscriptionQueues();
+    }
 
     Camera2D::UpdateCameraPosition(deltaTime);
     StepPhysics();
+
+    {
+        ProfileScope profileScope(PROFILE_TRANSFORMS);
+        Transform::UpdateWorldTransforms();
+    }
 }
 
 void GameEngine::Render() {
+    ProfileScope profileScope(PROFILE_RENDER);
+    auto renderStart = std::chrono::high_resolution_clock::now();
+
     SDL_SetRenderDrawColor(renderer, clearColorR, clearColorG, clearColorB, SDL_ALPHA_OPAQUE); // In case a pixel draw call changed it
     SDL_RenderClear(renderer);
 
@@ -310,9 +540,42 @@ void GameEngine::Render() {
     TextManager::DrawRequestQueue();
     ImageManager::DrawPixelRequestQueue();
 
+    // Measured before the present, which waits for vsync and would otherwise eat the whole budget
+    lastRenderMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - renderStart).count();
+
     SDL_RenderPresent(renderer);
 }
 
+// Runs between Update and Render, with the automatic collector stopped. A cycle starts once the heap has doubled since the
+// last one finished, like Lua's default pause, then basic incremental steps run until the frame budget is spent. Frames
+// already over budget put it off until the heap has grown by gcDeferLimitKb, and then advance it by a single step.
+void GameEngine::CollectLuaGarbage() {
+    ProfileScope profileScope(PROFILE_LUA_GC);
+
+    int heapKb = lua_gc(luaState, LUA_GCCOUNT);
+    int allocatedKb = heapKb - gcHeapKbAfterCycle;
+
+    auto deadline = lastFrameTime + std::chrono::duration<double, std::milli>(frameBudgetMs - lastRenderMs);
+    bool withinBudget = std::chrono::high_resolution_clock::now() < deadline;
+
+    bool cycleDue = gcCycleRunning || heapKb >= 2 * gcHeapKbAfterCycle;
+    if (cycleDue && (withinBudget || allocatedKb >= gcDeferLimitKb)) {
+        do {
+            // A basic step does a fixed amount of work, whatever the collector's own pause says
+            if (lua_gc(luaState, LUA_GCSTEP, 0)) {
+                gcCycleRunning = false;
+                gcHeapKbAfterCycle = lua_gc(luaState, LUA_GCCOUNT);
+                break;
+            }
+            gcCycleRunning = true;
+        } while (std::chrono::high_resolution_clock::now() < deadline);
+
+        heapKb = lua_gc(luaState, LUA_GCCOUNT);
+    }
+
+    Profiler::SetLuaHeapKb(heapKb + lua_gc(luaState, LUA_GCCOUNTB) / 1024.0);
+}
+
 void GameEngine::LoadResources() {
     std::string resourcesPath = "resources/";
 
@@ -368,12 +631,54 @@ void GameEngine::LoadResources() {
         windowTitle = config["game_title"].GetString();
     }
 
+    if (config.HasMember("physics_step_rate")) {
+        timeStep = 1.0f / config["physics_step_rate"].GetFloat();
+    }
+
+    if (config.HasMember("max_physics_steps")) {
+        maxPhysicsSteps = config["max_physics_steps"].GetInt();
+    }
+
+    // One worker per spare core by default, islands are solved on the main thread too
+    int physicsThreads = std::min(static_cast<int>(std::thread::hardware_concurrency()) - 1, 7);
+    if (config.HasMember("physics_threads")) {
+        physicsThreads = config["physics_threads"].GetInt();
+    }
+    world->SetWorkerCount(std::max(physicsThreads, 0));
+
+    if (config.HasMember("physics_wide_solver")) {
+        world->SetWideContactSolver(config["physics_wide_solver"].GetBool());
+    }
+
+    if (config.HasMember("frame_budget_ms")) {
+        frameBudgetMs = config["frame_budget_ms"].GetFloat();
+    }
+
+    if (config.HasMember("gc_defer_limit_kb")) {
+        gcDeferLimitKb = config["gc_defer_limit_kb"].GetInt();
+    }
+
+    if (config.HasMember("scene_load_budget_ms")) {
+        SceneManager::SetLoadBudget(config["scene_load_budget_ms"].GetFloat());
+    }
+
 
     // Set window and renderer ASAP to avoid load order problems
-    window = SDL_CreateWindow(windowTitle.c_str(), SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, windowWidth, windowHeight, SDL_WINDOW_SHOWN);
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_PRESENTVSYNC | SDL_RENDERER_ACCELERATED);
+    if (headless) {
+        // Draw calls still do real work, they just land in a surface nobody looks at
+        headlessSurface = SDL_CreateRGBSurfaceWithFormat(0, windowWidth, windowHeight, 32, SDL_PIXELFORMAT_RGBA32);
+        renderer = SDL_CreateSoftwareRenderer(headlessSurface);
+    }
+    else {
+        window = SDL_CreateWindow(windowTitle.c_str(), SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, windowWidth, windowHeight, SDL_WINDOW_SHOWN);
+        renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_PRESENTVSYNC | SDL_RENDERER_ACCELERATED);
+    }
     SDL_SetRenderDrawColor(renderer, clearColorR, clearColorG, clearColorB, SDL_ALPHA_OPAQUE);
 
+    if (config.HasMember("preload_component_types") && config["preload_component_types"].GetBool()) {
+        ComponentManager::PreloadComponentTypes();
+    }
+
     if (config.HasMember("initial_scene")) {
         const std::string& sceneName = config["initial_scene"].GetString();
         SceneManager::LoadScene(sceneName);
@@ -407,5 +712,39 @@ float GameEngine::ApplicationTime() {
 }
 
 void GameEngine::StepPhysics() {
-    world->Step(deltaTime, 8, 3);
+    ProfileScope profileScope(PROFILE_STEP_PHYSICS);
+
+    // Run the world at a fixed rate no matter how long the frame took
+    physicsAccumulator += deltaTime;
+
+    int steps = 0;
+    while (physicsAccumulator >= timeStep && steps < maxPhysicsSteps) {
+        Rigidbody::SavePreviousTransforms();
+        world->Step(timeStep, 8, 3);
+        physicsAccumulator -= timeStep;
+        steps++;
+    }
+
+    // Fell too far behind, drop the backlog instead of spiraling
+    if (steps == maxPhysicsSteps && physicsAccumulator >= timeStep)
+        physicsAccumulator = 0.0f;
+
+    Rigidbody::SetInterpolationAlpha(physicsAccumulator / timeStep);
+    SyncPhysicsTransforms();
+
+    // Scripts hear about contacts only now, with the world unlocked and every body where the step left it
+    contactListener->DispatchEvents();
+}
+
+// Copies every body's interpolated position and angle into its actor's Transform in one sweep, so scripts
+// read plain numbers from transform.x/y/rotation instead of each allocating a Vector2 from its Rigidbody.
+// Bodies are in world space, a parented transform gets the pose relative to its parent.
+void GameEngine::SyncPhysicsTransforms() {
+    for (b2Body* b = world->GetBodyList(); b != nullptr; b = b->GetNext()) {
+        Rigidbody* rb = reinterpret_cast<Rigidbody*>(b->GetUserData().pointer);
+        if (rb == nullptr || rb->transform == nullptr)
+            continue;
+
+        rb->transform->SetWorldPose(rb->GetInterpolatedPosition(), rb->GetInterpolatedRotation());
+    }
 }
@@ -2,6 +2,8 @@
 #include <iostream>
 #include <filesystem>
 #include "Camera2D.h"
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 void ImageManager::Initialize(SDL_Renderer* _renderer) {
@@ -9,15 +11,16 @@ void ImageManager::Initialize(SDL_Renderer* _renderer) {
     renderer = _renderer;
 }
 
-SDL_Texture* ImageManager::LoadImage(const std::string& imageName) {
-    std::string filePath = imageFolderPath + imageName + ".png";
+// Returns the handle for an image, loading it the first time it is requested
+int ImageManager::LoadImageHandle(const std::string& imageName) {
     // Check if the image is already loaded
-    auto it = textures.find(imageName);
-    if (it != textures.end()) {
-        // Image is already loaded, return the existing texture
+    auto it = imageHandles.find(imageName);
+    if (it != imageHandles.end()) {
         return it->second;
     }
 
+    std::string filePath = imageFolderPath + imageName + ".png";
+
     // Load the image as a texture
     SDL_Texture* texture = IMG_LoadTexture(renderer, filePath.c_str());
 
@@ -26,30 +29,135 @@ SDL_Texture* ImageManager::LoadImage(const std::string& imageName) {
         exit(0);
     }
 
-    // Store the texture in the map and return it
-    textures[imageName] = texture;
-    return texture;
+    // Cache the size too so drawing never has to query the texture
+    int width, height;
+    SDL_QueryTexture(texture, nullptr, nullptr, &width, &height);
+
+    int handle = static_cast<int>(images.size());
+    images.push_back({ texture, static_cast<float>(width), static_cast<float>(height) });
+    imageHandles[imageName] = handle;
+    return handle;
+}
+
+// Blank texture that can be drawn into with SDL_SetRenderTarget, drawn like any loaded image
+int ImageManager::CreateTargetImage(int width, int height) {
+    SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, width, height);
+
+    if (texture == nullptr) {
+        std::cout << "error: failed to create render target " << SDL_GetError();
+        exit(0);
+    }
+
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+
+    LoadedImage image = { texture, static_cast<float>(width), static_cast<float>(height) };
+
+    if (!freeImageHandles.empty()) {
+        int handle = freeImageHandles.back();
+        freeImageHandles.pop_back();
+        images[handle] = image;
+        return handle;
+    }
+
+    images.push_back(image);
+    return static_cast<int>(images.size()) - 1;
+}
+
+// Only for images from CreateTargetImage, named images stay loaded for the whole game
+void ImageManager::DestroyImage(int image) {
+    SDL_DestroyTexture(images[image].texture);
+    images[image] = { nullptr, 0.0f, 0.0f };
+    freeImageHandles.push_back(image);
+}
+
+const LoadedImage& ImageManager::GetImage(int image) {
+    return images[image];
+}
+
+SDL_Renderer* ImageManager::GetRenderer() {
+    return renderer;
+}
+
+void ImageManager::SubmitUIDrawRequest(int image, float x, float y) {
+    UIRequestQueue.emplace_back(image, x, y);
+}
+
+void ImageManager::SubmitUIExDrawRequest(int image, float x, float y, float r, float g, float b, float a, float sortingOrder, float rotationDegrees, float scaleX, float scaleY, float pivotX, float pivotY) {
+    UIRequestQueue.emplace_back(image, x, y, rotationDegrees, scaleX, scaleY, pivotX, pivotY, r, g, b, a, sortingOrder);
+}
+
+void ImageManager::SubmitScreenSpaceDrawRequest(int image, float x, float y) {
+    screenSpaceRequestQueue.emplace_back(image, x, y);
+}
+
+void ImageManager::SubmitScreenSpaceExDrawRequest(int image, float x, float y, float rotationDegrees, float scaleX, float scaleY, float pivotX, float pivotY, float r, float g, float b, float a, float sortingOrder) {
+    screenSpaceRequestQueue.emplace_back(image, x, y, rotationDegrees, scaleX, scaleY, pivotX, pivotY, r, g, b, a, sortingOrder);
+}
+
+// Accepts a handle as-is and interns names, so scripts can pass either
+int ImageManager::GetImageArgument(lua_State* L, int index) {
+    if (lua_type(L, index) == LUA_TNUMBER) {
+        lua_Integer handle = lua_tointeger(L, index);
+        if (handle < 0 || handle >= static_cast<lua_Integer>(images.size()) || images[handle].texture == nullptr)
+            luaL_argerror(L, index, "invalid image handle");
+        return static_cast<int>(handle);
+    }
+
+    return LoadImageHandle(luaL_checkstring(L, index));
+}
+
+static float CheckFloat(lua_State* L, int index) {
+    return static_cast<float>(luaL_checknumber(L, index));
 }
 
-void ImageManager::SubmitUIDrawRequest(const std::string& imageName, float x, float y) {
-    ScreenSpaceDrawRequest request(imageName, x, y);
-    UIRequestQueue.push_back(request);
+static float OptFloat(lua_State* L, int index, float defaultValue) {
+    return static_cast<float>(luaL_optnumber(L, index, defaultValue));
 }
 
-void ImageManager::SubmitUIExDrawRequest(const std::string& imageName, float x, float y, float r, float g, float b, float a, float sortingOrder, float rotationDegrees, float scaleX, float scaleY, float pivotX, float pivotY) {
-    ScreenSpaceDrawRequest request(imageName, x, y, rotationDegrees, scaleX, scaleY, pivotX, pivotY, r, g, b, a, sortingOrder);
-    UIRequestQueue.push_back(request);
+// Image.Load(name) -> handle
+int ImageManager::LuaLoad(lua_State* L) {
+    lua_pushinteger(L, LoadImageHandle(luaL_checkstring(L, 1)));
+    return 1;
 }
 
+// Image.DrawUI(image, x, y)
+int ImageManager::LuaDrawUI(lua_State* L) {
+    SubmitUIDrawRequest(GetImageArgument(L, 1), CheckFloat(L, 2), CheckFloat(L, 3));
+    return 0;
+}
 
-void ImageManager::SubmitScreenSpaceDrawRequest(const std::string& imageName, float x, float y) {
-    ScreenSpaceDrawRequest request(imageName, x, y);
-    screenSpaceRequestQueue.push_back(request);
+// Image.DrawUIEx(image, x, y, r, g, b, a, sorting_order, [rotation, scale_x, scale_y, pivot_x, pivot_y])
+int ImageManager::LuaDrawUIEx(lua_State* L) {
+    SubmitUIExDrawRequest(GetImageArgument(L, 1), CheckFloat(L, 2), CheckFloat(L, 3),
+        CheckFloat(L, 4), CheckFloat(L, 5), CheckFloat(L, 6), CheckFloat(L, 7), CheckFloat(L, 8),
+        OptFloat(L, 9, 0.0f), OptFloat(L, 10, 1.0f), OptFloat(L, 11, 1.0f), OptFloat(L, 12, 0.5f), OptFloat(L, 13, 0.5f));
+    return 0;
 }
 
-void ImageManager::SubmitScreenSpaceExDrawRequest(const std::string& imageName, float x, float y, float rotationDegrees, float scaleX, float scaleY, float pivotX, float pivotY, float r, float g, float b, float a, float sortingOrder) {
-    ScreenSpaceDrawRequest request(imageName, x, y, rotationDegrees, scaleX, scaleY, pivotX, pivotY, r, g, b, a, sortingOrder);
-    screenSpaceRequestQueue.push_back(request);
+// Image.Draw(image, x, y)
+int ImageManager::LuaDraw(lua_State* L) {
+    SubmitScreenSpaceDrawRequest(GetImageArgument(L, 1), CheckFloat(L, 2), CheckFloat(L, 3));
+    return 0;
+}
+
+// Image.DrawEx(image, x, y, rotation, scale_x, scale_y, pivot_x, pivot_y, r, g, b, a, sorting_order)
+int ImageManager::LuaDrawEx(lua_State* L) {
+    SubmitScreenSpaceExDrawRequest(GetImageArgument(L, 1), CheckFloat(L, 2), CheckFloat(L, 3),
+        CheckFloat(L, 4), CheckFloat(L, 5), CheckFloat(L, 6), CheckFloat(L, 7), CheckFloat(L, 8),
+        CheckFloat(L, 9), CheckFloat(L, 10), CheckFloat(L, 11), CheckFloat(L, 12), CheckFloat(L, 13));
+    return 0;
+}
+
+// Image.GetDrawStats() -> { submitted, culled, drawn } for the last rendered frame
+int ImageManager::LuaGetDrawStats(lua_State* L) {
+    lua_createtable(L, 0, 3);
+    lua_pushinteger(L, drawStats.submitted);
+    lua_setfield(L, -2, "submitted");
+    lua_pushinteger(L, drawStats.culled);
+    lua_setfield(L, -2, "culled");
+    lua_pushinteger(L, drawStats.drawn);
+    lua_setfield(L, -2, "drawn");
+    return 1;
 }
 
 void ImageManager::SubmitPixelDrawRequest(float x, float y, float r, float g, float b, float a) {
@@ -61,65 +169,98 @@ void ImageManager::DrawUIRequestQueue() {
     if (UIRequestQueue.empty())
         return;
 
-    std::stable_sort(UIRequestQueue.begin(), UIRequestQueue.end(), [](const ScreenSpaceDrawRequest& a, const ScreenSpaceDrawRequest& b) {
-        return a.sortingOrder < b.sortingOrder;
-    });
-    
-    for (const ScreenSpaceDrawRequest& request : UIRequestQueue) {
-        SDL_Texture* texture = LoadImage(request.imageName);
-        DrawScreenSpace(texture, request, false);
-    }
-
-    UIRequestQueue.clear();
+    DrawSpriteBatch(UIRequestQueue, false);
 }
 
 void ImageManager::DrawScreenSpaceRequestQueue() {
-    if (screenSpaceRequestQueue.empty())
-        return;
+    drawStats.submitted = static_cast<int>(screenSpaceRequestQueue.size());
 
-    std::stable_sort(screenSpaceRequestQueue.begin(), screenSpaceRequestQueue.end(), [](const ScreenSpaceDrawRequest& a, const ScreenSpaceDrawRequest& b) {
-        return a.sortingOrder < b.sortingOrder;
+    // Drop everything outside the view before paying for the sort. The render scale is applied
+    // after positioning, so the visible region in sprite coordinates is the window shrunk by the zoom.
+    float viewWidth = Camera2D::GetSize().x / Camera2D::zoomFactor;
+    float viewHeight = Camera2D::GetSize().y / Camera2D::zoomFactor;
+
+    auto firstCulled = std::remove_if(screenSpaceRequestQueue.begin(), screenSpaceRequestQueue.end(), [=](const ScreenSpaceDrawRequest& request) {
+        return !IsVisible(request, viewWidth, viewHeight);
     });
+    screenSpaceRequestQueue.erase(firstCulled, screenSpaceRequestQueue.end());
 
-    SDL_RenderSetScale(renderer, Camera2D::zoomFactor, Camera2D::zoomFactor);
+    drawStats.drawn = static_cast<int>(screenSpaceRequestQueue.size());
+    drawStats.culled = drawStats.submitted - drawStats.drawn;
 
-    for (const ScreenSpaceDrawRequest& request : screenSpaceRequestQueue) {
-        SDL_Texture* texture = LoadImage(request.imageName);
-        DrawScreenSpace(texture, request);
-    }
+    if (screenSpaceRequestQueue.empty())
+        return;
 
+    SDL_RenderSetScale(renderer, Camera2D::zoomFactor, Camera2D::zoomFactor);
+    DrawSpriteBatch(screenSpaceRequestQueue, true);
     SDL_RenderSetScale(renderer, 1, 1);
-
-    screenSpaceRequestQueue.clear();
 }
 
-void ImageManager::DrawPixelRequestQueue() {
-    if (pixelRequestQueue.empty())
-        return;
+// Tests the sprite's screen AABB against the view. Rotated sprites use the circle swept by
+// their farthest corner around the pivot, which is cheap and never culls anything visible.
+bool ImageManager::IsVisible(const ScreenSpaceDrawRequest& request, float viewWidth, float viewHeight) {
+    const LoadedImage& image = images[request.image];
+    float width = image.width * std::abs(request.scaleX);
+    float height = image.height * std::abs(request.scaleY);
+    float pivotX = request.pivotX * width;
+    float pivotY = request.pivotY * height;
+
+    glm::vec2 position = Camera2D::GetScreenPosition(glm::vec2(request.x, request.y));
 
-    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-    for (const PixelDrawRequest& request : pixelRequestQueue) {
-        SDL_SetRenderDrawColor(renderer, request.r, request.g, request.b, request.a);
-        SDL_RenderDrawPoint(renderer, request.x, request. y);
+    float left, right, top, bottom;
+
+    if (request.rotationDegrees == 0) {
+        left = position.x - pivotX;
+        right = position.x + width - pivotX;
+        top = position.y - pivotY;
+        bottom = position.y + height - pivotY;
+    }
+    else {
+        float reachX = std::max(pivotX, width - pivotX);
+        float reachY = std::max(pivotY, height - pivotY);
+        float radius = std::sqrt(reachX * reachX + reachY * reachY);
+        left = position.x - radius;
+        right = position.x + radius;
+        top = position.y - radius;
+        bottom = position.y + radius;
     }
-    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
 
-    pixelRequestQueue.clear();
+    return right >= 0.0f && left <= viewWidth && bottom >= 0.0f && top <= viewHeight;
 }
 
-void ImageManager::DrawScreenSpace(SDL_Texture* texture, const ScreenSpaceDrawRequest& request, bool moveWithCamera) {
-    int textureWidth, textureHeight;
-    SDL_QueryTexture(texture, nullptr, nullptr, &textureWidth, &textureHeight);
-    
-    SDL_Point pivot;
-    pivot.x = static_cast<int>(request.pivotX * textureWidth * request.scaleX);
-    pivot.y = static_cast<int>(request.pivotY * textureHeight * request.scaleY);
+// Sorts by (sortingOrder, texture) and submits each run of same-texture sprites as one
+// SDL_RenderGeometry call. Tint and alpha are baked into the vertices instead of texture mod state.
+void ImageManager::DrawSpriteBatch(std::vector<ScreenSpaceDrawRequest>& requestQueue, bool moveWithCamera) {
+    // One handle per texture, so sorting on it groups same-texture runs
+    std::stable_sort(requestQueue.begin(), requestQueue.end(), [](const ScreenSpaceDrawRequest& a, const ScreenSpaceDrawRequest& b) {
+        if (a.sortingOrder != b.sortingOrder)
+            return a.sortingOrder < b.sortingOrder;
+        return a.image < b.image;
+    });
+
+    int currentImage = requestQueue.front().image;
 
-    SDL_Rect destRect;
+    for (const ScreenSpaceDrawRequest& request : requestQueue) {
+        if (request.image != currentImage) {
+            FlushSprites(images[currentImage].texture);
+            currentImage = request.image;
+        }
 
-    destRect.w = textureWidth * request.scaleX;
-    destRect.h = textureHeight * request.scaleY;
+        AppendSprite(request, moveWithCamera);
+    }
 
+    FlushSprites(images[currentImage].texture);
+    requestQueue.clear();
+}
+
+// Builds the same quad SDL_RenderCopyEx would draw: scaled around the pivot, rotated clockwise about it,
+// with negative scales flipping the texture coordinates
+void ImageManager::AppendSprite(const ScreenSpaceDrawRequest& request, bool moveWithCamera) {
+    const LoadedImage& image = images[request.image];
+    float width = image.width * std::abs(request.scaleX);
+    float height = image.height * std::abs(request.scaleY);
+    float pivotX = request.pivotX * width;
+    float pivotY = request.pivotY * height;
 
     glm::vec2 position;
 
@@ -128,36 +269,52 @@ void ImageManager::DrawScreenSpace(SDL_Texture* texture, const ScreenSpaceDrawRe
     else
         position = Camera2D::GetScreenPostionUnmodified(glm::vec2(request.x, request.y));
 
-    destRect.x = static_cast<int>(position.x - pivot.x);
-    destRect.y = static_cast<int>(position.y - pivot.y);
+    float u0 = request.scaleX > 0 ? 0.0f : 1.0f;
+    float u1 = 1.0f - u0;
+    float v0 = request.scaleY > 0 ? 0.0f : 1.0f;
+    float v1 = 1.0f - v0;
+
+    // Corners relative to the pivot, in the order top left, top right, bottom right, bottom left
+    const float cornersX[4] = { -pivotX, width - pivotX, width - pivotX, -pivotX };
+    const float cornersY[4] = { -pivotY, -pivotY, height - pivotY, height - pivotY };
+    const float texCoordsU[4] = { u0, u1, u1, u0 };
+    const float texCoordsV[4] = { v0, v0, v1, v1 };
 
-    bool horizontalFlip = request.scaleX > 0 ? false : true;
-    bool verticalFlip = request.scaleY > 0 ? false : true;
+    SDL_Color color = { static_cast<Uint8>(request.r), static_cast<Uint8>(request.g), static_cast<Uint8>(request.b), static_cast<Uint8>(request.a) };
 
-    SDL_RendererFlip flip = GetRendererFlip(horizontalFlip, verticalFlip);
+    float cosAngle = 1.0f, sinAngle = 0.0f;
+    if (request.rotationDegrees != 0) {
+        float radians = request.rotationDegrees * (3.14159265f / 180.0f);
+        cosAngle = std::cos(radians);
+        sinAngle = std::sin(radians);
+    }
 
-    SDL_SetTextureColorMod(texture, request.r, request.g, request.b);
-    SDL_SetTextureAlphaMod(texture, request.a);
+    int firstVertex = static_cast<int>(batchVertices.size());
 
-    SDL_RenderCopyEx(
-        renderer,
-        texture,
-        NULL, // Source rect
-        &destRect,
-        request.rotationDegrees,
-        &pivot,
-        flip
-    );
+    for (int i = 0; i < 4; i++) {
+        SDL_Vertex vertex;
+        vertex.position.x = position.x + cornersX[i] * cosAngle - cornersY[i] * sinAngle;
+        vertex.position.y = position.y + cornersX[i] * sinAngle + cornersY[i] * cosAngle;
+        vertex.color = color;
+        vertex.tex_coord.x = texCoordsU[i];
+        vertex.tex_coord.y = texCoordsV[i];
+        batchVertices.push_back(vertex);
+    }
 
-    SDL_SetTextureColorMod(texture, 255, 255, 255);
-    SDL_SetTextureAlphaMod(texture, 255);
+    batchIndices.push_back(firstVertex);
+    batchIndices.push_back(firstVertex + 1);
+    batchIndices.push_back(firstVertex + 2);
+    batchIndices.push_back(firstVertex);
+    batchIndices.push_back(firstVertex + 2);
+    batchIndices.push_back(firstVertex + 3);
 }
 
-SDL_RendererFlip ImageManager::GetRendererFlip(bool horizontalFlip, bool verticalFlip) {
-    int flip = 0;
-    if (horizontalFlip)
-        flip |= SDL_FLIP_HORIZONTAL;
-    if (verticalFlip)
-        flip |= SDL_FLIP_VERTICAL;
-    return static_cast<SDL_RendererFlip>(flip);
-}
\ No newline at end of file
+void ImageManager::FlushSprites(SDL_Texture* texture) {
+    if (batchIndices.empty())
+        return;
+
+    SDL_RenderGeometry(renderer, texture, batchVertices.data(), static_cast<int>(batchVertices.size()), batchIndices.data(), static_cast<int>(batchIndices.size()));
+
+    batchVertices.clear();
+    batchIndices.clear();
+}
@@ -0,0 +1,140 @@
+#include "LuaAllocator.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+int LuaAllocator::GetSizeClass(size_t size) {
+    if (size <= 256)
+        return static_cast<int>((size + 15) / 16) - 1;
+
+    return 16 + static_cast<int>((size - 257) / 64);
+}
+
+size_t LuaAllocator::GetBlockSize(int sizeClass) {
+    if (sizeClass < 16)
+        return (sizeClass + 1) * 16;
+
+    return 256 + (sizeClass - 15) * 64;
+}
+
+void* LuaAllocator::AllocateBlock(int sizeClass) {
+    if (freeLists[sizeClass] == nullptr) {
+        // Carve a new chunk into blocks of this class and thread them into the free list
+        size_t blockSize = GetBlockSize(sizeClass);
+        size_t blockCount = chunkSize / blockSize;
+        char* chunk = static_cast<char*>(std::malloc(chunkSize));
+        if (chunk == nullptr)
+            return nullptr;
+
+        chunks.push_back(chunk);
+
+        for (size_t i = 0; i < blockCount - 1; i++) {
+            reinterpret_cast<FreeBlock*>(chunk + i * blockSize)->next = reinterpret_cast<FreeBlock*>(chunk + (i + 1) * blockSize);
+        }
+        reinterpret_cast<FreeBlock*>(chunk + (blockCount - 1) * blockSize)->next = nullptr;
+
+        freeLists[sizeClass] = reinterpret_cast<FreeBlock*>(chunk);
+    }
+
+    FreeBlock* block = freeLists[sizeClass];
+    freeLists[sizeClass] = block->next;
+
+    LuaAllocatorStats& stats = sizeClassStats[sizeClass];
+    stats.allocations++;
+    stats.liveBlocks++;
+    stats.peakLiveBlocks = std::max(stats.peakLiveBlocks, stats.liveBlocks);
+
+    return block;
+}
+
+void LuaAllocator::FreeBlockToList(void* block, int sizeClass) {
+    sizeClassStats[sizeClass].liveBlocks--;
+
+    FreeBlock* freed = static_cast<FreeBlock*>(block);
+    freed->next = freeLists[sizeClass];
+    freeLists[sizeClass] = freed;
+}
+
+// When block is null oldSize is the type of object being created, not a size
+void* LuaAllocator::Allocate(void* userData, void* block, size_t oldSize, size_t newSize) {
+    if (block == nullptr)
+        oldSize = 0;
+
+    if (newSize == 0) {
+        if (block == nullptr)
+            return nullptr;
+
+        if (oldSize <= maxBlockSize) {
+            FreeBlockToList(block, GetSizeClass(oldSize));
+        }
+        else {
+            largeStats.liveBlocks--;
+            largeLiveBytes -= oldSize;
+            std::free(block);
+        }
+        return nullptr;
+    }
+
+    // Same size class, the block already fits
+    if (block != nullptr && oldSize <= maxBlockSize && newSize <= maxBlockSize && GetSizeClass(oldSize) == GetSizeClass(newSize))
+        return block;
+
+    // Large to large can let realloc grow in place
+    if (block != nullptr && oldSize > maxBlockSize && newSize > maxBlockSize) {
+        void* resized = std::realloc(block, newSize);
+        if (resized == nullptr)
+            return nullptr;
+
+        largeStats.allocations++;
+        largeLiveBytes += newSize;
+        largeLiveBytes -= oldSize;
+        return resized;
+    }
+
+    void* newBlock;
+    if (newSize <= maxBlockSize) {
+        newBlock = AllocateBlock(GetSizeClass(newSize));
+    }
+    else {
+        newBlock = std::malloc(newSize);
+        if (newBlock != nullptr) {
+            largeStats.allocations++;
+            largeStats.liveBlocks++;
+            largeStats.peakLiveBlocks = std::max(largeStats.peakLiveBlocks, largeStats.liveBlocks);
+            largeLiveBytes += newSize;
+        }
+    }
+
+    // Null leaves the old block as it was, which is what Lua expects from a failed allocation
+    if (newBlock == nullptr)
+        return nullptr;
+
+    if (block != nullptr) {
+        std::memcpy(newBlock, block, std::min(oldSize, newSize));
+        Allocate(userData, block, oldSize, 0);
+    }
+
+    return newBlock;
+}
+
+void LuaAllocator::PrintReport() {
+    std::printf("\n==== Lua allocations (%zu pooled chunks, %zu KB) ====\n", chunks.size(), chunks.size() * chunkSize / 1024);
+    std::printf("%-12s %14s %12s %12s %14s\n", "block bytes", "allocations", "live", "peak live", "live bytes");
+
+    for (int i = 0; i < sizeClassCount; i++) {
+        const LuaAllocatorStats& stats = sizeClassStats[i];
+        if (stats.allocations == 0)
+            continue;
+
+        size_t blockSize = GetBlockSize(i);
+        std::printf("%-12zu %14llu %12llu %12llu %14llu\n", blockSize,
+            static_cast<unsigned long long>(stats.allocations), static_cast<unsigned long long>(stats.liveBlocks),
+            static_cast<unsigned long long>(stats.peakLiveBlocks), static_cast<unsigned long long>(stats.liveBlocks * blockSize));
+    }
+
+    std::printf("%-12s %14llu %12llu %12llu %14llu\n", "> 512",
+        static_cast<unsigned long long>(largeStats.allocations), static_cast<unsigned long long>(largeStats.liveBlocks),
+        static_cast<unsigned long long>(largeStats.peakLiveBlocks), static_cast<unsigned long long>(largeLiveBytes));
+    std::fflush(stdout);
+}
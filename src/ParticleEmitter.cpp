@@ -0,0 +1,195 @@
+#include "ParticleEmitter.h"
+#include "GameEngine.h"
+#include "ImageManager.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define PARTICLE_EMITTER_SSE
+#endif
+
+void ParticleEmitter::OnStart() {
+    if (!image.empty())
+        imageHandle = ImageManager::LoadImageHandle(image);
+
+    random.seed(nextSeed++);
+
+    // A negative max_particles would make reserve throw, treat it as no particles
+    maxParticles = std::max(maxParticles, 0);
+    positionX.reserve(maxParticles);
+    positionY.reserve(maxParticles);
+    velocityX.reserve(maxParticles);
+    velocityY.reserve(maxParticles);
+    age.reserve(maxParticles);
+    lifetimes.reserve(maxParticles);
+}
+
+void ParticleEmitter::OnUpdate() {
+    float deltaTime = GameEngine::GetDeltaTime();
+
+    emitAccumulator += emitRate * deltaTime;
+    int toEmit = static_cast<int>(emitAccumulator);
+    emitAccumulator -= toEmit;
+
+    Emit(toEmit);
+    Simulate(deltaTime);
+    RemoveExpired();
+    Draw();
+}
+
+void ParticleEmitter::Burst(int count) {
+    Emit(count);
+}
+
+void ParticleEmitter::Clear() {
+    positionX.clear();
+    positionY.clear();
+    velocityX.clear();
+    velocityY.clear();
+    age.clear();
+    lifetimes.clear();
+}
+
+int ParticleEmitter::GetParticleCount() {
+    return static_cast<int>(positionX.size());
+}
+
+void ParticleEmitter::Emit(int count) {
+    // max_particles can still be set from Lua after OnStart
+    count = std::min(count, std::max(maxParticles, 0) - GetParticleCount());
+
+    std::uniform_real_distribution<float> angleDistribution(std::min(angleMin, angleMax), std::max(angleMin, angleMax));
+    std::uniform_real_distribution<float> speedDistribution(std::min(speedMin, speedMax), std::max(speedMin, speedMax));
+    std::uniform_real_distribution<float> lifetimeDistribution(-std::abs(lifetimeVariance), std::abs(lifetimeVariance));
+
+    for (int i = 0; i < count; i++) {
+        float radians = angleDistribution(random) * (3.14159265f / 180.0f);
+        float speed = speedDistribution(random);
+
+        positionX.push_back(x);
+        positionY.push_back(y);
+        velocityX.push_back(std::cos(radians) * speed);
+        velocityY.push_back(std::sin(radians) * speed);
+        age.push_back(0.0f);
+        lifetimes.push_back(std::max(lifetime + lifetimeDistribution(random), 0.001f));
+    }
+}
+
+void ParticleEmitter::Simulate(float deltaTime) {
+    size_t count = positionX.size();
+    float gravityStepX = gravityX * deltaTime;
+    float gravityStepY = gravityY * deltaTime;
+    float damping = std::max(0.0f, 1.0f - drag * deltaTime);
+
+    size_t i = 0;
+
+#ifdef PARTICLE_EMITTER_SSE
+    __m128 deltaTimes = _mm_set1_ps(deltaTime);
+    __m128 gravityStepsX = _mm_set1_ps(gravityStepX);
+    __m128 gravityStepsY = _mm_set1_ps(gravityStepY);
+    __m128 dampings = _mm_set1_ps(damping);
+
+    for (; i + 4 <= count; i += 4) {
+        __m128 vx = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(&velocityX[i]), gravityStepsX), dampings);
+        __m128 vy = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(&velocityY[i]), gravityStepsY), dampings);
+        _mm_storeu_ps(&velocityX[i], vx);
+        _mm_storeu_ps(&velocityY[i], vy);
+        _mm_storeu_ps(&positionX[i], _mm_add_ps(_mm_loadu_ps(&positionX[i]), _mm_mul_ps(vx, deltaTimes)));
+        _mm_storeu_ps(&positionY[i], _mm_add_ps(_mm_loadu_ps(&positionY[i]), _mm_mul_ps(vy, deltaTimes)));
+        _mm_storeu_ps(&age[i], _mm_add_ps(_mm_loadu_ps(&age[i]), deltaTimes));
+    }
+#endif
+
+    // Remainder, or everything when SSE is unavailable. The compiler is free to vectorize this too.
+    for (; i < count; i++) {
+        velocityX[i] = (velocityX[i] + gravityStepX) * damping;
+        velocityY[i] = (velocityY[i] + gravityStepY) * damping;
+        positionX[i] += velocityX[i] * deltaTime;
+        positionY[i] += velocityY[i] * deltaTime;
+        age[i] += deltaTime;
+    }
+}
+
+// Swaps each expired particle with the last one, so order is not preserved
+void ParticleEmitter::RemoveExpired() {
+    size_t i = 0;
+
+    while (i < age.size()) {
+        if (age[i] < lifetimes[i]) {
+            i++;
+            continue;
+        }
+
+        positionX[i] = positionX.back();
+        positionY[i] = positionY.back();
+        velocityX[i] = velocityX.back();
+        velocityY[i] = velocityY.back();
+        age[i] = age.back();
+        lifetimes[i] = lifetimes.back();
+
+        positionX.pop_back();
+        positionY.pop_back();
+        velocityX.pop_back();
+        velocityY.pop_back();
+        age.pop_back();
+        lifetimes.pop_back();
+    }
+}
+
+// Every particle shares the image and sorting order, so the batcher draws them all in one geometry call
+void ParticleEmitter::Draw() {
+    if (imageHandle == -1)
+        return;
+
+    size_t count = positionX.size();
+
+    for (size_t i = 0; i < count; i++) {
+        float t = age[i] / lifetimes[i];
+        float scale = startScale + (endScale - startScale) * t;
+
+        ImageManager::SubmitScreenSpaceExDrawRequest(imageHandle, positionX[i], positionY[i], 0.0f, scale, scale, 0.5f, 0.5f,
+            startColorR + (endColorR - startColorR) * t,
+            startColorG + (endColorG - startColorG) * t,
+            startColorB + (endColorB - startColorB) * t,
+            startColorA + (endColorA - startColorA) * t,
+            static_cast<float>(sortingOrder));
+    }
+}
+
+std::shared_ptr<ParticleEmitter> ParticleEmitter::Clone(Actor* actor) const {
+    auto clone = std::make_shared<ParticleEmitter>();
+
+    clone->image = this->image;
+    clone->x = this->x;
+    clone->y = this->y;
+    clone->emitRate = this->emitRate;
+    clone->maxParticles = this->maxParticles;
+    clone->lifetime = this->lifetime;
+    clone->lifetimeVariance = this->lifetimeVariance;
+    clone->speedMin = this->speedMin;
+    clone->speedMax = this->speedMax;
+    clone->angleMin = this->angleMin;
+    clone->angleMax = this->angleMax;
+    clone->gravityX = this->gravityX;
+    clone->gravityY = this->gravityY;
+    clone->drag = this->drag;
+    clone->startScale = this->startScale;
+    clone->endScale = this->endScale;
+    clone->startColorR = this->startColorR;
+    clone->startColorG = this->startColorG;
+    clone->startColorB = this->startColorB;
+    clone->startColorA = this->startColorA;
+    clone->endColorR = this->endColorR;
+    clone->endColorG = this->endColorG;
+    clone->endColorB = this->endColorB;
+    clone->endColorA = this->endColorA;
+    clone->sortingOrder = this->sortingOrder;
+    clone->type = this->type;
+    clone->key = this->key;
+    clone->enabled = this->enabled;
+
+    clone->actor = actor;
+
+    return clone;
+}
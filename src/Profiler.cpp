@@ -0,0 +1,98 @@
+// Profiler.cpp
+#include "Profiler.h"
+#include <algorithm>
+#include <cstdio>
+
+static const char* phaseNames[PROFILE_PHASE_COUNT] = {
+    "ProcessInput",
+    "LoadScene",
+    "OnStart",
+    "OnUpdate",
+    "OnLateUpdate",
+    "OnDestroy",
+    "UpdateAllActorComponents",
+    "ProcessActorQueues",
+    "EventBus",
+    "StepPhysics",
+    "Transforms",
+    "LuaGC",
+    "Render"
+};
+
+void Profiler::SetEnabled(bool enable) {
+    enabled = enable;
+}
+
+bool Profiler::IsEnabled() {
+    return enabled;
+}
+
+void Profiler::BeginFrame() {
+    if (!enabled)
+        return;
+
+    frameStart = std::chrono::high_resolution_clock::now();
+    if (frameCount == 0)
+        runStart = frameStart;
+
+    std::fill(std::begin(frameMs), std::end(frameMs), 0.0);
+}
+
+void Profiler::EndFrame() {
+    if (!enabled)
+        return;
+
+    auto now = std::chrono::high_resolution_clock::now();
+    double totalMs = std::chrono::duration<double, std::milli>(now - frameStart).count();
+
+    // Fold this frame's phase times into the running stats
+    for (int i = 0; i < PROFILE_PHASE_COUNT; i++) {
+        PhaseStats& stats = phaseStats[i];
+        stats.totalMs += frameMs[i];
+        stats.minMs = frameCount == 0 ? frameMs[i] : std::min(stats.minMs, frameMs[i]);
+        stats.maxMs = std::max(stats.maxMs, frameMs[i]);
+    }
+
+    frameStats.totalMs += totalMs;
+    frameStats.minMs = frameCount == 0 ? totalMs : std::min(frameStats.minMs, totalMs);
+    frameStats.maxMs = std::max(frameStats.maxMs, totalMs);
+
+    luaHeapStats.totalMs += frameLuaHeapKb;
+    luaHeapStats.minMs = frameCount == 0 ? frameLuaHeapKb : std::min(luaHeapStats.minMs, frameLuaHeapKb);
+    luaHeapStats.maxMs = std::max(luaHeapStats.maxMs, frameLuaHeapKb);
+
+    frameCount++;
+}
+
+void Profiler::AddPhaseTime(ProfilePhase phase, double ms) {
+    frameMs[phase] += ms;
+}
+
+// Heap size once the frame's collection work is done
+void Profiler::SetLuaHeapKb(double kb) {
+    frameLuaHeapKb = kb;
+}
+
+void Profiler::PrintReport() {
+    if (!enabled || frameCount == 0)
+        return;
+
+    double wallSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - runStart).count();
+
+    std::printf("\n==== Frame timing report (%llu frames, %.3f s wall, %.1f frames/s) ====\n",
+        static_cast<unsigned long long>(frameCount), wallSeconds, frameCount / wallSeconds);
+    std::printf("%-26s %12s %10s %10s %10s %7s\n", "phase", "total ms", "avg ms", "min ms", "max ms", "frame%");
+
+    for (int i = 0; i < PROFILE_PHASE_COUNT; i++) {
+        const PhaseStats& stats = phaseStats[i];
+        double share = frameStats.totalMs > 0.0 ? 100.0 * stats.totalMs / frameStats.totalMs : 0.0;
+        std::printf("%-26s %12.3f %10.4f %10.4f %10.4f %6.1f%%\n",
+            phaseNames[i], stats.totalMs, stats.totalMs / frameCount, stats.minMs, stats.maxMs, share);
+    }
+
+    std::printf("%-26s %12.3f %10.4f %10.4f %10.4f %6.1f%%\n",
+        "Frame", frameStats.totalMs, frameStats.totalMs / frameCount, frameStats.minMs, frameStats.maxMs, 100.0);
+    std::printf("%-26s %12s %10.1f %10.1f %10.1f\n",
+        "Lua heap KB", "", luaHeapStats.totalMs / frameCount, luaHeapStats.minMs, luaHeapStats.maxMs);
+    std::fflush(stdout);
+}
@@ -1,12 +1,12 @@
 #include "SceneManager.h"
+#include <climits>
 
-static std::shared_ptr<Actor> ParseActor(const rapidjson::Value& actorDocument) {
-    std::shared_ptr<Actor> actor = std::make_shared<Actor>();
+static void ParseActor(Actor* actor, CompiledAsset& sceneAsset, AssetReader& reader) {
     std::shared_ptr<Actor> actorTemplate;
-    std::unordered_set<std::string> templateComponentKeys;
 
-    if (actorDocument.HasMember("template")) {
-        actorTemplate = TemplateManager::LoadTemplate(actorDocument["template"].GetString());
+    uint32_t templateName = reader.ReadUInt();
+    if (templateName != noAssetString) {
+        actorTemplate = TemplateManager::LoadTemplate(std::string(sceneAsset.GetString(templateName)));
         *actor = *actorTemplate;
 
         // Add lifecycle for inherited components
@@ -14,100 +14,53 @@ static std::shared_ptr<Actor> ParseActor(const rapidjson::Value& actorDocument)
             luabridge::LuaRef component = componentPair.second;
             std::string componentKey = componentPair.first;
             actor->InjectConvenienceReference(component);
-            templateComponentKeys.insert(componentKey);
             actor->AddComponentLifecycle(component, componentKey);
         }
     }
 
-    if (actorDocument.HasMember("name")) {
-        actor->name = actorDocument["name"].GetString();
+    uint32_t actorName = reader.ReadUInt();
+    if (actorName != noAssetString) {
+        actor->name = sceneAsset.GetString(actorName);
     }
 
-    if (actorDocument.HasMember("components")) {
-        const rapidjson::GenericObject componentsObject = actorDocument["components"].GetObject();
-
-        // Iterate through all components in this actor
-        for (rapidjson::Value::ConstMemberIterator componentsItr = componentsObject.MemberBegin(); componentsItr != componentsObject.MemberEnd(); componentsItr++) {
-            std::string componentKey = componentsItr->name.GetString();
-
-            bool inherited = false;
-            // If the component was inherited, mark it as so
-            if (templateComponentKeys.find(componentKey) != std::end(templateComponentKeys))
-                inherited = true;
-
-
-            if (inherited) {
-                luabridge::LuaRef component = actor->components.find(componentKey)->second;
-                // Iterate through the type and overrides of each individual component
-                for (rapidjson::Value::ConstMemberIterator componentMemberItr = componentsItr->value.MemberBegin(); componentMemberItr != componentsItr->value.MemberEnd(); componentMemberItr++) {
-
-                    std::string componentMemberName = componentMemberItr->name.GetString();
-                    // Handle component member override
-                    if (componentMemberName != "type") {
-                        std::string componentMemberToOverride = componentMemberItr->name.GetString();
-                        const rapidjson::Value& overrideValue = componentMemberItr->value;
-
-                        // Override the component member with the new value
-                        if (overrideValue.IsString()) {
-                            component[componentMemberToOverride] = overrideValue.GetString();
-                        }
-                        else if (overrideValue.IsInt()) {
-                            component[componentMemberToOverride] = overrideValue.GetInt();
-                        }
-                        else if (overrideValue.IsDouble()) {
-                            component[componentMemberToOverride] = overrideValue.GetDouble();
-                        }
-                        else if (overrideValue.IsBool()) {
-                            component[componentMemberToOverride] = overrideValue.GetBool();
-                        }
-                    }
-                }
-
-                actor->AddComponentLifecycle(component, componentKey);
+    // Iterate through all components in this actor
+    uint32_t numComponents = reader.ReadUInt();
+    for (uint32_t i = 0; i < numComponents; i++) {
+        std::string componentKey(sceneAsset.GetString(reader.ReadUInt()));
+        uint32_t componentType = reader.ReadUInt();
+        uint32_t numOverrides = reader.ReadUInt();
+
+        // If the component was inherited, only apply the overrides
+        if (actorTemplate && actorTemplate->components.find(componentKey) != std::end(actorTemplate->components)) {
+            luabridge::LuaRef component = actor->components.find(componentKey)->second;
+
+            for (uint32_t j = 0; j < numOverrides; j++) {
+                ComponentManager::ApplyOverride(component, sceneAsset, reader);
+            }
+        }
+
+        else {
+            if (componentType == noAssetString) {
+                std::cout << "error: component " << componentKey << " on actor " << actor->name << " has no type";
+                exit(0);
             }
 
-            else {
-                std::string componentFileName = componentsItr->value["type"].GetString();
-                luabridge::LuaRef component = ComponentManager::LoadComponent(componentKey, componentFileName);
-                actor->InjectConvenienceReference(component);
-                actor->components.insert(std::pair(componentKey, component));
-                actor->componentsByType[componentFileName].insert(componentKey);
-
-                // Iterate through the type and overrides of each individual component
-                for (rapidjson::Value::ConstMemberIterator componentMemberItr = componentsItr->value.MemberBegin(); componentMemberItr != componentsItr->value.MemberEnd(); componentMemberItr++) {
-
-                    std::string componentMemberName = componentMemberItr->name.GetString();
-                    // Handle component member override
-                    if (componentMemberName != "type") {
-                        const rapidjson::Value& overrideValue = componentMemberItr->value;
-
-                        // Override the component member with the new value
-                        if (overrideValue.IsString()) {
-                            component[componentMemberName] = overrideValue.GetString();
-                        }
-                        else if (overrideValue.IsInt()) {
-                            component[componentMemberName] = overrideValue.GetInt();
-                        }
-                        else if (overrideValue.IsDouble()) {
-                            component[componentMemberName] = overrideValue.GetDouble();
-                        }
-                        else if (overrideValue.IsBool()) {
-                            component[componentMemberName] = overrideValue.GetBool();
-                        }
-                    }
-                }
-
-                actor->AddComponentLifecycle(component, componentKey);
+            std::string componentFileName(sceneAsset.GetString(componentType));
+            luabridge::LuaRef component = ComponentManager::LoadComponent(componentKey, componentFileName);
+            actor->InjectConvenienceReference(component);
+            actor->components.insert(std::pair(componentKey, component));
+            actor->componentsByType[componentFileName].insert(componentKey);
+
+            for (uint32_t j = 0; j < numOverrides; j++) {
+                ComponentManager::ApplyOverride(component, sceneAsset, reader);
             }
+
+            actor->AddComponentLifecycle(component, componentKey);
         }
     }
-
-    return actor;
 }
 
-void SceneManager::LoadScene(const std::string& name) {
-    loadingNewScene = false;
-
+static std::string GetScenePath(const std::string& name) {
     std::string scenePath = "resources/scenes/" + name + ".scene";
 
     if (!std::filesystem::exists(scenePath)) {
@@ -115,124 +68,314 @@ void SceneManager::LoadScene(const std::string& name) {
         exit(0);
     }
 
-    // Clear previous scene information
-    actorVector.clear();
+    return scenePath;
+}
+
+// Loads and builds the whole scene right away, used for the initial scene
+void SceneManager::LoadScene(const std::string& name) {
+    loadingNewScene = false;
+
+    BeginSceneBuild(name, AssetCache::Load(GetScenePath(name)));
+    BuildSceneActors(-1.0f);
+}
+
+// Compiles or maps the scene and every template it uses on a worker thread, nothing here touches Lua.
+// ContinueSceneLoad builds the actors once the worker is done.
+void SceneManager::LoadSceneAsync(const std::string& name) {
+    loadingNewScene = false;
 
-    actorVector = dontDestroyOnLoadActors;
+    std::string scenePath = GetScenePath(name);
+    pendingSceneName = name;
+    pendingScene = std::async(std::launch::async, [scenePath]() {
+        // Errors are thrown into the future, ContinueSceneLoad reports them on the main thread
+        std::shared_ptr<CompiledAsset> sceneAsset = AssetCache::TryLoad(scenePath);
+
+        for (std::string_view templateName : sceneAsset->GetTemplateNames()) {
+            std::string templatePath = TemplateManager::GetTemplatePath(std::string(templateName));
+            if (std::filesystem::exists(templatePath))
+                AssetCache::TryLoad(templatePath);
+        }
 
-    std::sort(std::begin(actorVector), std::end(actorVector), [](std::shared_ptr<Actor> a, std::shared_ptr<Actor> b) {
-        return a->id < b->id;
+        return sceneAsset;
     });
 
-    actorMap.clear();
+    // A build still in progress is abandoned, its actors were already flagged for removal by Scene.Load
+    sceneBuildAsset.reset();
+    sceneBuildReader.reset();
+}
 
-    for (std::shared_ptr<Actor> actor : actorVector) {
-        actorMap[actor->name].push_back(actor);
+void SceneManager::ContinueSceneLoad() {
+    if (pendingScene.valid() && pendingScene.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        std::shared_ptr<CompiledAsset> sceneAsset;
+        try {
+            sceneAsset = pendingScene.get();
+        }
+        catch (const std::exception& e) {
+            std::cout << e.what();
+            exit(0);
+        }
+
+        BeginSceneBuild(pendingSceneName, sceneAsset);
     }
 
-    sceneName = name;
+    if (sceneBuildAsset == nullptr)
+        return;
 
-    rapidjson::Document sceneDocument;
-    ReadJsonFile(scenePath, sceneDocument);
-    ParseScene(sceneDocument);
+    // The OnStart calls for last frame's actors come out of this frame's budget
+    BuildSceneActors(std::max(0.0f, sceneLoadBudget - lastOnStartSeconds));
 }
 
-void SceneManager::ParseScene(const rapidjson::Document& sceneDoc) {
-    const rapidjson::Value& actorsArray = sceneDoc["actors"];
-    rapidjson::SizeType numActors = actorsArray.Size();
+void SceneManager::BeginSceneBuild(const std::string& name, std::shared_ptr<CompiledAsset> sceneAsset) {
+    // The previous scene's actors were removed when the load started, only DontDestroy actors
+    // and anything they instantiated since are left
+    sceneName = name;
+
+    sceneBuildAsset = sceneAsset;
+    sceneBuildReader.emplace(sceneAsset->GetActors());
+    sceneBuildTotal = sceneBuildReader->ReadUInt();
+    sceneBuildCount = 0;
+
     // reserve memory in the actors array in advance
-    actorVector.reserve(numActors);
-    rapidjson::SizeType i;
-
-    // Parse the actorObj into an scene actor
-    for (i = 0; i < numActors; i++) {
-        const rapidjson::Value& actorObj = actorsArray[i];
-        std::shared_ptr<Actor> actor = ParseActor(actorObj);
-        actor->id = i + totalActors;
+    actorVector.reserve(actorVector.size() + sceneBuildTotal);
+}
+
+// Builds actors until the budget in seconds is spent, or all of them when it is negative.
+// At least one actor is built per call so a slow frame can't stall the load.
+void SceneManager::BuildSceneActors(float budgetSeconds) {
+    auto start = std::chrono::steady_clock::now();
+
+    while (sceneBuildCount < sceneBuildTotal) {
+        std::shared_ptr<Actor> actor = std::make_shared<Actor>();
+        AllocateActorSlot(actor.get());
+        ParseActor(actor.get(), *sceneBuildAsset, *sceneBuildReader);
+        actor->id = totalActors++;
+        actor->denseIndex = static_cast<uint32_t>(actorVector.size());
         actorVector.push_back(actor);
         actorMap[actor->name].push_back(actor);
+        sceneBuildCount++;
+
+        if (budgetSeconds >= 0.0f && std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count() >= budgetSeconds)
+            break;
+    }
+
+    if (sceneBuildCount == sceneBuildTotal) {
+        sceneBuildReader.reset();
+        sceneBuildAsset.reset();
     }
+}
+
+bool SceneManager::IsLoading() {
+    return loadingNewScene || pendingScene.valid() || sceneBuildAsset != nullptr;
+}
+
+// 0 while the worker is reading the scene, then the fraction of actors built
+float SceneManager::GetLoadProgress() {
+    if (loadingNewScene || pendingScene.valid())
+        return 0.0f;
 
-    totalActors += i;
+    if (sceneBuildAsset == nullptr || sceneBuildTotal == 0)
+        return 1.0f;
+
+    return static_cast<float>(sceneBuildCount) / static_cast<float>(sceneBuildTotal);
+}
+
+void SceneManager::SetLoadBudget(float milliseconds) {
+    sceneLoadBudget = milliseconds / 1000.0f;
 }
 
 void SceneManager::RunOnStartLifecycleFunctions() {
-    for (std::shared_ptr<Actor> actor : actorVector) {
-        std::map<std::string, luabridge::LuaRef>& onStartComponents = actor->onStartComponents;
+    auto start = std::chrono::steady_clock::now();
+    RunLifecycleFunctions(OnStart, "OnStart");
+    lastOnStartSeconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+}
 
-        for (auto& pair : onStartComponents) {
-            // If the actor gets disabled, don't finish running its components
-            if (actor->enabled == false)
-                break;
+void SceneManager::RunOnUpdateLifecycleFunctions() {
+    RunLifecycleFunctions(OnUpdate, "OnUpdate");
+    RunUpdateBatches();
+}
 
-            luabridge::LuaRef component = pair.second;
+void SceneManager::RunOnLateUpdateLifecycleFunctions() {
+    RunLifecycleFunctions(OnLateUpdate, "OnLateUpdate");
+}
 
-            if (component["enabled"] == false)
-                continue;
-            try {
-                component["OnStart"](component);
-            }
-            catch (luabridge::LuaException e) {
-                std::string errorMessage = e.what();
-                std::replace(std::begin(errorMessage), std::end(errorMessage), '\\', '/');
-                std::cout << "\033[31m" << actor->GetName() << " : " << errorMessage << "\033[0m" << std::endl;
-            }
+static bool LifecycleEntryLess(const LifecycleEntry& a, const LifecycleEntry& b) {
+    if (a.actor->id != b.actor->id)
+        return a.actor->id < b.actor->id;
+    return a.key < b.key;
+}
+
+// Only the entries added since the last sort are sorted, then merged into the rest. New actors always have
+// larger ids, so the merge is usually skipped, it's only needed after AddComponent on an existing actor.
+static void SortLifecycleEntries(std::vector<LifecycleEntry>& entries, size_t& sortedCount) {
+    if (sortedCount == entries.size())
+        return;
+
+    auto middle = std::begin(entries) + sortedCount;
+    std::stable_sort(middle, std::end(entries), LifecycleEntryLess);
+
+    if (sortedCount > 0 && LifecycleEntryLess(*middle, *(middle - 1)))
+        std::inplace_merge(std::begin(entries), middle, std::end(entries), LifecycleEntryLess);
+
+    sortedCount = entries.size();
+}
+
+// Removes entries in order and keeps count of how many at the front are still sorted
+template <typename Predicate>
+static void EraseLifecycleEntries(std::vector<LifecycleEntry>& entries, size_t& sortedCount, Predicate isRemoved) {
+    auto middle = std::begin(entries) + sortedCount;
+    auto sortedEnd = std::remove_if(std::begin(entries), middle, isRemoved);
+    auto end = std::remove_if(middle, std::end(entries), isRemoved);
+
+    // Close the gap, a LuaRef can't be assigned to itself
+    if (sortedEnd != middle)
+        end = std::move(middle, end, sortedEnd);
+
+    sortedCount = static_cast<size_t>(sortedEnd - std::begin(entries));
+    entries.erase(end, std::end(entries));
+}
+
+void SceneManager::RunLifecycleFunctions(LifecycleFunctionType type, const char* functionName) {
+    std::vector<LifecycleEntry>& entries = lifecycleEntries[type];
+
+    SortLifecycleEntries(entries, lifecycleEntriesSorted[type]);
+
+    // Entries registered during the pass wait for the next one, like they did with the per-actor maps
+    size_t numEntries = entries.size();
+
+    for (size_t i = 0; i < numEntries; i++) {
+        LifecycleEntry& entry = entries[i];
+        Actor* actor = entry.actor;
+
+        // If the actor gets disabled, don't finish running its components
+        if (actor->enabled == false || *entry.enabled == false)
+            continue;
+
+        try {
+            entry.function(entry.component);
+        }
+        catch (luabridge::LuaException e) {
+            std::string errorMessage = e.what();
+            std::replace(std::begin(errorMessage), std::end(errorMessage), '\\', '/');
+            std::cout << "\033[31m" << actor->GetName() << " : " << errorMessage << "\033[0m" << std::endl;
         }
+    }
 
-        onStartComponents.clear();
+    // OnStart only ever runs once per component
+    if (type == OnStart) {
+        entries.erase(std::begin(entries), std::begin(entries) + numEntries);
+        lifecycleEntriesSorted[type] = 0;
     }
 }
 
-void SceneManager::RunOnUpdateLifecycleFunctions() {
-    for (std::shared_ptr<Actor> actor : actorVector) {
-        std::map<std::string, luabridge::LuaRef>& onUpdateComponents = actor->onUpdateComponents;
-
-        for (auto& pair : onUpdateComponents) {
-            // If the actor gets disabled, don't finish running its components
-            if (actor->enabled == false)
-                break;
-            luabridge::LuaRef component = pair.second;
-            if (component["enabled"] == false)
+// Batched types run after all per-instance OnUpdate calls, in type name order
+void SceneManager::RunUpdateBatches() {
+    for (auto& pair : updateBatches) {
+        LifecycleBatch& batch = pair.second;
+
+        SortLifecycleEntries(batch.entries, batch.sortedCount);
+
+        // Refill the reused instances table in place, no per-frame table or LuaRef allocation
+        batch.instances.push(luaState);
+        int previousCount = static_cast<int>(lua_rawlen(luaState, -1));
+        int count = 0;
+
+        for (const LifecycleEntry& entry : batch.entries) {
+            if (entry.actor->enabled == false || *entry.enabled == false)
                 continue;
-            try {
-                component["OnUpdate"](component);
-            }
-            catch (luabridge::LuaException e) {
-                std::string errorMessage = e.what();
-                std::replace(std::begin(errorMessage), std::end(errorMessage), '\\', '/');
-                std::cout << "\033[31m" << actor->GetName() << " : " << errorMessage << "\033[0m" << std::endl;
-            }
+
+            entry.component.push(luaState);
+            lua_rawseti(luaState, -2, ++count);
+        }
+
+        for (int i = count + 1; i <= previousCount; i++) {
+            lua_pushnil(luaState);
+            lua_rawseti(luaState, -2, i);
+        }
+
+        lua_pop(luaState, 1);
+
+        if (count == 0)
+            continue;
+
+        try {
+            batch.function(batch.instances);
+        }
+        catch (luabridge::LuaException e) {
+            std::string errorMessage = e.what();
+            std::replace(std::begin(errorMessage), std::end(errorMessage), '\\', '/');
+            std::cout << "\033[31m" << pair.first << " : " << errorMessage << "\033[0m" << std::endl;
         }
     }
 }
 
-void SceneManager::RunOnLateUpdateLifecycleFunctions() {
-    for (std::shared_ptr<Actor> actor : actorVector) {
-        std::map<std::string, luabridge::LuaRef>& onLateUpdateComponents = actor->onLateUpdateComponents;
+void SceneManager::AddComponentLifecycle(Actor* actor, const std::string& key, luabridge::LuaRef component, LifecycleFunctionType type, luabridge::LuaRef function) {
+    component.push(luaState);
+    const void* identity = lua_topointer(luaState, -1);
+    lua_pop(luaState, 1);
 
-        for (auto& pair : onLateUpdateComponents) {
-            // If the actor gets disabled, don't finish running its components
-            if (actor->enabled == false)
-                break;
+    lifecycleEntries[type].emplace_back(actor, key, identity, ComponentManager::GetEnabledFlag(component), component, function);
+}
 
-            luabridge::LuaRef component = pair.second;
-            if (component["enabled"] == false)
-                continue;
-            try {
-                component["OnLateUpdate"](component);
-            }
-            catch (luabridge::LuaException e) {
-                std::string errorMessage = e.what();
-                std::replace(std::begin(errorMessage), std::end(errorMessage), '\\', '/');
-                std::cout << "\033[31m" << actor->GetName() << " : " << errorMessage << "\033[0m" << std::endl;
-            }
-        }
+void SceneManager::AddComponentUpdateBatch(Actor* actor, const std::string& key, luabridge::LuaRef component, const std::string& type, luabridge::LuaRef function) {
+    auto it = updateBatches.find(type);
+
+    if (it == std::end(updateBatches))
+        it = updateBatches.emplace(type, LifecycleBatch(function, luabridge::newTable(luaState))).first;
+
+    component.push(luaState);
+    const void* identity = lua_topointer(luaState, -1);
+    lua_pop(luaState, 1);
+
+    it->second.entries.emplace_back(actor, key, identity, ComponentManager::GetEnabledFlag(component), component, function);
+}
+
+void SceneManager::RemoveComponentLifecycle(luabridge::LuaRef component) {
+    component.push(luaState);
+    removedLifecycleComponents.insert(lua_topointer(luaState, -1));
+    lua_pop(luaState, 1);
+}
+
+// Drops entries for removed components and actors in one pass per list.
+// Runs right after the removals so a recycled address can never match a new component.
+void SceneManager::FlushRemovedLifecycleEntries() {
+    if (removedLifecycleComponents.empty() && removedLifecycleActors.empty())
+        return;
+
+    auto isRemoved = [](const LifecycleEntry& entry) {
+        return removedLifecycleComponents.find(entry.identity) != std::end(removedLifecycleComponents)
+            || removedLifecycleActors.find(entry.actor) != std::end(removedLifecycleActors);
+    };
+
+    for (int type = 0; type < numLifecycleFunctionTypes; type++) {
+        EraseLifecycleEntries(lifecycleEntries[type], lifecycleEntriesSorted[type], isRemoved);
+    }
+
+    for (auto& pair : updateBatches) {
+        EraseLifecycleEntries(pair.second.entries, pair.second.sortedCount, isRemoved);
     }
+
+    removedLifecycleComponents.clear();
+    removedLifecycleActors.clear();
+}
+
+static int GetQueuedActorID(const ActorHandle& handle) {
+    Actor* actor = SceneManager::ResolveActor(handle);
+    return actor == nullptr ? INT_MAX : actor->id;
 }
 
 void SceneManager::RunOnDestroyLifecycleFunctions() {
-    for (std::shared_ptr<Actor> actor : actorVector) {
-        actor->ProcessDestroyedComponents();
+    // Actor id order, same as the actor list used to give
+    std::sort(std::begin(actorsWithComponentChanges), std::end(actorsWithComponentChanges), [](const ActorHandle& a, const ActorHandle& b) {
+        return GetQueuedActorID(a) < GetQueuedActorID(b);
+    });
+
+    // OnDestroy may queue more changes, those wait for the next frame
+    size_t numQueued = actorsWithComponentChanges.size();
+
+    for (size_t i = 0; i < numQueued; i++) {
+        Actor* actor = ResolveActor(actorsWithComponentChanges[i]);
+        if (actor != nullptr && actor->denseIndex != invalidActorIndex)
+            actor->ProcessDestroyedComponents();
     }
 }
 
@@ -296,18 +439,102 @@ luabridge::LuaRef SceneManager::GetAllActors(const std::string& actorName) {
 }
 
 void SceneManager::UpdateAllActorComponents() {
-    for (std::shared_ptr<Actor> actor : actorVector) {
+    size_t numKept = 0;
+
+    for (size_t i = 0; i < actorsWithComponentChanges.size(); i++) {
+        const ActorHandle handle = actorsWithComponentChanges[i];
+        Actor* actor = ResolveActor(handle);
+        if (actor == nullptr)
+            continue;
+
+        // Actors instantiated this frame get their components set up by ProcessActorQueues first
+        if (actor->denseIndex == invalidActorIndex) {
+            actorsWithComponentChanges[numKept++] = handle;
+            continue;
+        }
+
         actor->ProcessComponentQueues();
+        actor->componentChangesQueued = false;
+    }
+
+    actorsWithComponentChanges.resize(numKept);
+    FlushRemovedLifecycleEntries();
+}
+
+void SceneManager::QueueComponentChanges(Actor* actor) {
+    if (actor->componentChangesQueued)
+        return;
+
+    actor->componentChangesQueued = true;
+    actorsWithComponentChanges.push_back(actor->GetHandle());
+}
+
+Actor* SceneManager::ResolveActor(const ActorHandle& handle) {
+    if (handle.slot >= actorSlots.size())
+        return nullptr;
+
+    const ActorSlot& slot = actorSlots[handle.slot];
+    return slot.generation == handle.generation ? slot.actor : nullptr;
+}
+
+void SceneManager::AllocateActorSlot(Actor* actor) {
+    if (freeActorSlots.empty()) {
+        actor->slot = static_cast<uint32_t>(actorSlots.size());
+        actorSlots.emplace_back();
     }
+    else {
+        actor->slot = freeActorSlots.back();
+        freeActorSlots.pop_back();
+    }
+
+    actorSlots[actor->slot].actor = actor;
+    actor->generation = actorSlots[actor->slot].generation;
+}
+
+void SceneManager::ReleaseActorSlot(Actor* actor) {
+    ActorSlot& slot = actorSlots[actor->slot];
+    slot.actor = nullptr;
+    slot.generation++;
+    freeActorSlots.push_back(actor->slot);
+    actor->slot = invalidActorIndex;
 }
 
 Actor* SceneManager::InstantiateActor(const std::string& templateName) {
-    std::shared_ptr<Actor> actor = std::make_shared<Actor>();;
-    std::shared_ptr<Actor> actorTemplate = TemplateManager::LoadTemplate(templateName);
-    *actor = *actorTemplate;
+    std::shared_ptr<Actor> actor;
+    std::vector<std::shared_ptr<Actor>>& pool = actorPools[templateName];
+
+    // The slot comes first, components hold the actor's handle from the moment they get it
+    if (!pool.empty()) {
+        // Pooled actors were reset when they were destroyed, so they only need a new slot and id
+        actor = std::move(pool.back());
+        pool.pop_back();
+        AllocateActorSlot(actor.get());
+
+        // Resetting dropped the handle from the Lua instances, and the old one names a released slot
+        for (auto& componentPair : actor->components) {
+            actor->InjectConvenienceReference(componentPair.second);
+        }
+
+        // Transforms gave up their slot with the actor, pooled actors stay out of the hierarchy pass
+        auto transformKeys = actor->componentsByType.find("Transform");
+        if (transformKeys != std::end(actor->componentsByType)) {
+            for (const std::string& key : transformKeys->second) {
+                auto component = actor->components.find(key);
+                if (component != std::end(actor->components))
+                    component->second.cast<Transform*>()->Reattach();
+            }
+        }
+    }
+    else {
+        actor = std::make_shared<Actor>();
+        AllocateActorSlot(actor.get());
+        *actor = *TemplateManager::LoadTemplate(templateName);
+        actor->templateName = templateName;
+    }
 
+    actor->poolable = true;
     actor->id = totalActors;
-    totalActors++;;
+    totalActors++;
 
     actorsToAdd.push_back(actor);
     actorMap[actor->name].push_back(actor); // It's ok to add it to the actor map
@@ -318,6 +545,7 @@ Actor* SceneManager::InstantiateActor(const std::string& templateName) {
 void SceneManager::ProcessActorQueues() {
     for (std::shared_ptr<Actor> actor : actorsToAdd) {
         // Add actor to data structures
+        actor->denseIndex = static_cast<uint32_t>(actorVector.size());
         actorVector.push_back(actor);
 
         for (std::pair<std::string, luabridge::LuaRef> componentPair : actor->components) {
@@ -333,38 +561,72 @@ void SceneManager::ProcessActorQueues() {
     if (actorsToRemove.empty())
         return;
 
-    int numActorsLeft = actorsToRemove.size();
-
-    for (auto it = std::begin(actorVector); it != std::end(actorVector);) {
-        Actor* actorPtr = it->get();
-        if (actorsToRemove.find(actorPtr) != std::end(actorsToRemove)) {
-            // Remove from actorVector
-            it = actorVector.erase(it);
-            auto& vec = actorMap[actorPtr->GetName()];
-            for (auto it2 = std::begin(vec); it2 != std::end(vec);) {
-                Actor* actorPtr2 = it2->get();
-                if (actorPtr2 == actorPtr) {
-                    vec.erase(it2);
-                    numActorsLeft--;
-                    if (numActorsLeft <= 0)
-                        break;
-                }
-                else {
-                    ++it2;
-                }
-            }
-            if (numActorsLeft <= 0)
-                break;
+    for (Actor* actor : actorsToRemove) {
+        if (actor->denseIndex == invalidActorIndex)
+            continue;
+
+        removedLifecycleActors.insert(actor);
+
+        auto it = actorMap.find(actor->name);
+        if (it != std::end(actorMap))
+            actorListsToCompact.push_back(&it->second);
+
+        // Swap with the last actor and pop, the list has no order to keep
+        uint32_t index = actor->denseIndex;
+        std::shared_ptr<Actor> removed = std::move(actorVector[index]);
+        if (index != actorVector.size() - 1) {
+            actorVector[index] = std::move(actorVector.back());
+            actorVector[index]->denseIndex = index;
         }
-        else {
-            ++it; // Only increment if no erase was performed
+        actorVector.pop_back();
+
+        actor->denseIndex = invalidActorIndex;
+
+        // Actors dropped by a scene load, or destroyed by another actor's OnDestroy this frame, never ran OnDestroy.
+        // Their bodies, chunks and transform slots are released here, before the actor can be freed, since fixtures
+        // and slots still point at it.
+        for (auto& componentPair : actor->components) {
+            ComponentManager::ReleaseNativeComponent(componentPair.second);
         }
+
+        // Only destroyed actors go back to their pool, ones dropped by a scene load never had OnDestroy run.
+        // Pooled actors keep their slot until OnReset has run, so their handles still resolve in it.
+        if (actor->destroyed && actor->poolable)
+            actorsToPool.push_back(std::move(removed));
+        else
+            ReleaseActorSlot(actor);
     }
 
+    auto isRemoved = [](const std::shared_ptr<Actor>& actor) {
+        return actorsToRemove.find(actor.get()) != std::end(actorsToRemove);
+    };
+
+    // One compaction pass per list instead of an erase per removed actor
+    std::sort(std::begin(actorListsToCompact), std::end(actorListsToCompact));
+    actorListsToCompact.erase(std::unique(std::begin(actorListsToCompact), std::end(actorListsToCompact)), std::end(actorListsToCompact));
+
+    for (std::vector<std::shared_ptr<Actor>>* actors : actorListsToCompact) {
+        actors->erase(std::remove_if(std::begin(*actors), std::end(*actors), isRemoved), std::end(*actors));
+    }
+
+    actorListsToCompact.clear();
     actorsToRemove.clear();
+    FlushRemovedLifecycleEntries();
+
+    // Reset last, a component's OnReset may already instantiate or destroy actors again
+    for (std::shared_ptr<Actor>& actor : actorsToPool) {
+        actor->ResetToTemplate(*TemplateManager::LoadTemplate(actor->templateName));
+        ReleaseActorSlot(actor.get());
+        actorPools[actor->templateName].push_back(std::move(actor));
+    }
+    actorsToPool.clear();
 }
 
 void SceneManager::DestroyActor(Actor* actor) {
+    // Handle to an actor that is already gone
+    if (actor == nullptr)
+        return;
+
     actorsToRemove.insert(actor);
     actor->SetupForDestruction();
     actor->enabled = false;
@@ -375,18 +637,15 @@ std::string SceneManager::GetCurrentSceneName() {
 }
 
 void SceneManager::DontDestroy(Actor* actor) {
-    std::vector<std::shared_ptr<Actor>> vector = actorMap[actor->name];
-
-    for (std::shared_ptr<Actor> a : vector) {
-        if (a.get() == actor)
-            dontDestroyOnLoadActors.push_back(a);
-    }
+    if (actor != nullptr)
+        actor->dontDestroyOnLoad = true;
 }
 
 void SceneManager::LoadSceneRuntime(const std::string& sceneName) {
     for (std::shared_ptr<Actor> actor : actorVector)
     {
-        actorsToRemove.insert(actor.get());
+        if (!actor->dontDestroyOnLoad)
+            actorsToRemove.insert(actor.get());
     }
 
     loadingNewScene = true;
@@ -1,71 +1,62 @@
 #include "TemplateManager.h"
 
 std::shared_ptr<Actor> TemplateManager::LoadTemplate(const std::string& templateName) {
-    std::string templatePath = "resources/actor_templates/" + templateName + ".template";
+    // If the template already exists, return it
+    auto it = templateMap.find(templateName);
+    if (it != std::end(templateMap))
+        return it->second;
+
+    std::string templatePath = GetTemplatePath(templateName);
 
     if (!std::filesystem::exists(templatePath)) {
         std::cout << "error: template " << templateName << " is missing";
         exit(0);
     }
 
-    // If the template already exists, return it
-    if (templateMap.find(templateName) != std::end(templateMap))
-        return templateMap[templateName];
-
-    rapidjson::Document templateDocument;
-
-    ReadJsonFile(templatePath, templateDocument);
-    templateMap[templateName] = ParseTemplate(templateDocument);
+    std::shared_ptr<CompiledAsset> templateAsset = AssetCache::Load(templatePath);
+    templateMap[templateName] = ParseTemplate(*templateAsset);
     return templateMap[templateName];
 }
 
-std::shared_ptr<Actor> TemplateManager::ParseTemplate(const rapidjson::Document& templateDocument) {
-    std::shared_ptr<Actor> actor = std::make_shared<Actor>();
-
-    if (templateDocument.HasMember("name")) {
-        actor->name = templateDocument["name"].GetString();
-    }
+std::string TemplateManager::GetTemplatePath(const std::string& templateName) {
+    return "resources/actor_templates/" + templateName + ".template";
+}
 
-    if (templateDocument.HasMember("components")) {
-        const rapidjson::GenericObject componentsObject = templateDocument["components"].GetObject();
+std::shared_ptr<Actor> TemplateManager::ParseTemplate(CompiledAsset& templateAsset) {
+    std::shared_ptr<Actor> actor = std::make_shared<Actor>();
 
-        // Iterate through all components in this actor
-        for (rapidjson::Value::ConstMemberIterator componentsItr = componentsObject.MemberBegin(); componentsItr != componentsObject.MemberEnd(); componentsItr++) {
-            std::string componentKey = componentsItr->name.GetString();
+    AssetReader reader = templateAsset.GetActors();
+    reader.ReadUInt(); // Actor count, always one for a template
+    reader.ReadUInt(); // Templates can't inherit from other templates
 
-            // Handle component type declaration
-            std::string componentFileName = componentsItr->value["type"].GetString();
-            luabridge::LuaRef component = ComponentManager::LoadComponent(componentKey, componentFileName);
+    uint32_t actorName = reader.ReadUInt();
+    if (actorName != noAssetString) {
+        actor->name = templateAsset.GetString(actorName);
+    }
 
-            actor->components.insert(std::pair(componentKey, component));
-            actor->componentsByType[component["type"].tostring()].insert(componentKey);
+    // Iterate through all components in this actor
+    uint32_t numComponents = reader.ReadUInt();
+    for (uint32_t i = 0; i < numComponents; i++) {
+        std::string componentKey(templateAsset.GetString(reader.ReadUInt()));
+        uint32_t componentType = reader.ReadUInt();
+        uint32_t numOverrides = reader.ReadUInt();
+
+        // Handle component type declaration
+        if (componentType == noAssetString) {
+            std::cout << "error: component " << componentKey << " on template " << actor->name << " has no type";
+            exit(0);
+        }
 
-            // Iterate through the type and overrides of each individual component
-            for (rapidjson::Value::ConstMemberIterator componentMemberItr = componentsItr->value.MemberBegin(); componentMemberItr != componentsItr->value.MemberEnd(); componentMemberItr++) {
+        std::string componentFileName(templateAsset.GetString(componentType));
+        luabridge::LuaRef component = ComponentManager::LoadComponent(componentKey, componentFileName);
 
-                std::string componentMemberName = componentMemberItr->name.GetString();
-                // Handle component member override
-                if (componentMemberName != "type") {
-                    std::string componentMemberToOverride = componentMemberItr->name.GetString();
-                    const rapidjson::Value& overrideValue = componentMemberItr->value;
+        actor->components.insert(std::pair(componentKey, component));
+        actor->componentsByType[component["type"].tostring()].insert(componentKey);
 
-                    // Override the component member with the new value
-                    if (overrideValue.IsString()) {
-                        component[componentMemberToOverride] = overrideValue.GetString();
-                    }
-                    else if (overrideValue.IsInt()) {
-                        component[componentMemberToOverride] = overrideValue.GetInt();
-                    }
-                    else if (overrideValue.IsDouble()) {
-                        component[componentMemberToOverride] = overrideValue.GetDouble();
-                    }
-                    else if (overrideValue.IsBool()) {
-                        component[componentMemberToOverride] = overrideValue.GetBool();
-                    }
-                }
-            }
+        for (uint32_t j = 0; j < numOverrides; j++) {
+            ComponentManager::ApplyOverride(component, templateAsset, reader);
         }
     }
 
     return actor;
-}
\ No newline at end of file
+}
@@ -1,6 +1,8 @@
 // TextManager.cpp
 
 #include "TextManager.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <filesystem>
 #include "glm/glm.hpp"
@@ -47,29 +49,239 @@ void TextManager::DrawRequestQueue() {
         DrawText(request);
         textDrawRequestQueue.pop();
     }
+
+    FlushQuads();
+}
+
+// Builds the glyph atlas for a font the first time text is drawn with it
+GlyphAtlas& TextManager::LoadAtlas(TTF_Font* font) {
+    auto it = atlases.find(font);
+    if (it != std::end(atlases)) {
+        return it->second;
+    }
+
+    GlyphAtlas& atlas = atlases[font];
+    atlas.lineHeight = TTF_FontHeight(font);
+
+    // Glyphs are rendered white and tinted per vertex when drawn
+    SDL_Color white = { 255, 255, 255, 255 };
+    SDL_Surface* glyphSurfaces[atlasGlyphCount];
+    int glyphX[atlasGlyphCount], glyphY[atlasGlyphCount];
+
+    // Pack glyphs left to right in rows, one pixel apart so filtering never bleeds between them
+    int atlasWidth = std::max(512, atlas.lineHeight * 16);
+    int penX = 0, penY = 0, rowHeight = 0;
+
+    for (int i = 0; i < atlasGlyphCount; i++) {
+        Uint16 ch = static_cast<Uint16>(firstAtlasGlyph + i);
+        GlyphInfo& glyph = atlas.glyphs[i];
+
+        int minX = 0, maxX = 0, minY = 0, maxY = 0, advance = 0;
+        TTF_GlyphMetrics(font, ch, &minX, &maxX, &minY, &maxY, &advance);
+        glyph.advance = advance;
+        glyph.offsetX = std::min(0, minX);
+
+        glyphSurfaces[i] = TTF_RenderGlyph_Solid(font, ch, white);
+        glyph.width = glyphSurfaces[i] ? glyphSurfaces[i]->w : 0;
+        glyph.height = glyphSurfaces[i] ? glyphSurfaces[i]->h : 0;
+
+        if (penX + glyph.width > atlasWidth) {
+            penX = 0;
+            penY += rowHeight + 1;
+            rowHeight = 0;
+        }
+
+        glyphX[i] = penX;
+        glyphY[i] = penY;
+        penX += glyph.width + 1;
+        rowHeight = std::max(rowHeight, glyph.height);
+    }
+
+    int atlasHeight = std::max(1, penY + rowHeight);
+    SDL_Surface* atlasSurface = SDL_CreateRGBSurfaceWithFormat(0, atlasWidth, atlasHeight, 32, SDL_PIXELFORMAT_RGBA32);
+    SDL_FillRect(atlasSurface, nullptr, SDL_MapRGBA(atlasSurface->format, 0, 0, 0, 0));
+
+    for (int i = 0; i < atlasGlyphCount; i++) {
+        GlyphInfo& glyph = atlas.glyphs[i];
+
+        if (glyphSurfaces[i] == nullptr)
+            continue;
+
+        SDL_Rect destination = { glyphX[i], glyphY[i], glyph.width, glyph.height };
+        SDL_BlitSurface(glyphSurfaces[i], nullptr, atlasSurface, &destination);
+        SDL_FreeSurface(glyphSurfaces[i]);
+
+        glyph.u0 = static_cast<float>(glyphX[i]) / atlasWidth;
+        glyph.v0 = static_cast<float>(glyphY[i]) / atlasHeight;
+        glyph.u1 = static_cast<float>(glyphX[i] + glyph.width) / atlasWidth;
+        glyph.v1 = static_cast<float>(glyphY[i] + glyph.height) / atlasHeight;
+    }
+
+    atlas.texture = SDL_CreateTextureFromSurface(renderer, atlasSurface);
+    SDL_SetTextureBlendMode(atlas.texture, SDL_BLENDMODE_BLEND);
+    SDL_FreeSurface(atlasSurface);
+
+    return atlas;
+}
+
+static uint64_t HashText(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Counts one more draw of the string and returns the total, stopping at textCachePromoteCount
+int TextManager::CountTextDraw(const TextDrawRequest& request) {
+    uint64_t hash = 14695981039346656037ull;
+    hash = HashText(hash, request.fontName.data(), request.fontName.size() + 1);
+    hash = HashText(hash, &request.fontSize, sizeof(request.fontSize));
+    hash = HashText(hash, request.content.data(), request.content.size());
+
+    size_t slot = static_cast<size_t>(hash % textDrawCountSlots);
+    if (textDrawHashes[slot] != hash) {
+        textDrawHashes[slot] = hash;
+        textDrawCounts[slot] = 0;
+    }
+
+    textDrawCounts[slot] = std::min(textDrawCounts[slot] + 1, textCachePromoteCount);
+    return textDrawCounts[slot];
+}
+
+// Finds or creates the cache entry for a string and marks it most recently used
+CachedText& TextManager::TouchCachedText(const TextDrawRequest& request) {
+    textCacheKey.clear();
+    textCacheKey.append(request.fontName);
+    textCacheKey.push_back('\0');
+    textCacheKey.append(reinterpret_cast<const char*>(&request.fontSize), sizeof(request.fontSize));
+    textCacheKey.append(request.content);
+
+    auto it = textCache.find(textCacheKey);
+
+    if (it == std::end(textCache)) {
+        // Evict the least recently drawn string
+        if (textCache.size() >= textCacheCapacity) {
+            auto oldest = textCache.find(textCacheLru.back());
+            if (oldest->second.texture != nullptr)
+                SDL_DestroyTexture(oldest->second.texture);
+            textCache.erase(oldest);
+            textCacheLru.pop_back();
+        }
+
+        textCacheLru.push_front(textCacheKey);
+        it = textCache.emplace(textCacheKey, CachedText()).first;
+        it->second.lruPosition = std::begin(textCacheLru);
+    }
+    else {
+        textCacheLru.splice(std::begin(textCacheLru), textCacheLru, it->second.lruPosition);
+    }
+
+    return it->second;
+}
+
+void TextManager::RenderCachedText(CachedText& cachedText, TTF_Font* font, const std::string& content) {
+    SDL_Color white = { 255, 255, 255, 255 };
+    SDL_Surface* textSurface = TTF_RenderText_Solid(font, content.c_str(), white);
+
+    if (textSurface == nullptr)
+        return;
+
+    cachedText.texture = SDL_CreateTextureFromSurface(renderer, textSurface);
+    SDL_SetTextureBlendMode(cachedText.texture, SDL_BLENDMODE_BLEND);
+    cachedText.width = textSurface->w;
+    cachedText.height = textSurface->h;
+    SDL_FreeSurface(textSurface);
 }
 
 void TextManager::DrawText(const TextDrawRequest& request) {
+    if (request.content.empty())
+        return;
+
     TTF_Font* font = LoadFont(request.fontName, request.fontSize);
     SDL_Color color = { static_cast<Uint8>(request.r), static_cast<Uint8>(request.g), static_cast<Uint8>(request.b), static_cast<Uint8>(request.a) };
-    SDL_Surface* textSurface = TTF_RenderText_Solid(font, request.content.c_str(), color);
-    SDL_Texture* textTexture = SDL_CreateTextureFromSurface(renderer, textSurface);
+    glm::vec2 position = Camera2D::GetScreenPostionUnmodified(glm::vec2(request.x, request.y));
 
-    SDL_Point pivot;
-    pivot.x = static_cast<int>(0.5 * textSurface->w);
-    pivot.y = static_cast<int>(0.5 * textSurface->h);
+    bool inAtlas = std::all_of(std::begin(request.content), std::end(request.content), [](char ch) {
+        return ch >= firstAtlasGlyph && ch <= lastAtlasGlyph;
+    });
 
-    glm::vec2 position = Camera2D::GetScreenPostionUnmodified(glm::vec2(request.x, request.y));
+    // Strings drawn repeatedly (and anything the atlas can't spell) get a texture of their own.
+    // Anything else is laid out from the atlas without touching the cache.
+    if (!inAtlas || CountTextDraw(request) >= textCachePromoteCount) {
+        CachedText& cachedText = TouchCachedText(request);
 
-    SDL_Rect renderQuad;
+        if (cachedText.texture == nullptr)
+            RenderCachedText(cachedText, font, request.content);
 
-    renderQuad.x = static_cast<int>(position.x - pivot.x);
-    renderQuad.y = static_cast<int>(position.y - pivot.y);
-    renderQuad.w = textSurface->w;
-    renderQuad.h = textSurface->h;
+        if (cachedText.texture != nullptr) {
+            float x = std::floor(position.x - 0.5f * cachedText.width);
+            float y = std::floor(position.y - 0.5f * cachedText.height);
+            AppendQuad(cachedText.texture, x, y, static_cast<float>(cachedText.width), static_cast<float>(cachedText.height), 0.0f, 0.0f, 1.0f, 1.0f, color);
+            return;
+        }
+    }
 
-    SDL_RenderCopyEx(renderer, textTexture, NULL, &renderQuad, 0.0, NULL, SDL_FLIP_NONE);
-    SDL_FreeSurface(textSurface);
-    SDL_DestroyTexture(textTexture);
+    if (!inAtlas)
+        return;
+
+    // Lay the string out from the atlas, centered on the requested position like the rendered strings
+    GlyphAtlas& atlas = LoadAtlas(font);
+
+    int width = 0;
+    Uint16 previous = 0;
+    for (char ch : request.content) {
+        if (previous != 0)
+            width += TTF_GetFontKerningSizeGlyphs(font, previous, ch);
+        width += atlas.glyphs[ch - firstAtlasGlyph].advance;
+        previous = ch;
+    }
+
+    float penX = std::floor(position.x - 0.5f * width);
+    float penY = std::floor(position.y - 0.5f * atlas.lineHeight);
+
+    previous = 0;
+    for (char ch : request.content) {
+        if (previous != 0)
+            penX += TTF_GetFontKerningSizeGlyphs(font, previous, ch);
+
+        const GlyphInfo& glyph = atlas.glyphs[ch - firstAtlasGlyph];
+        if (glyph.width > 0)
+            AppendQuad(atlas.texture, penX + glyph.offsetX, penY, static_cast<float>(glyph.width), static_cast<float>(glyph.height), glyph.u0, glyph.v0, glyph.u1, glyph.v1, color);
+
+        penX += glyph.advance;
+        previous = ch;
+    }
+}
+
+void TextManager::AppendQuad(SDL_Texture* texture, float x, float y, float width, float height, float u0, float v0, float u1, float v1, SDL_Color color) {
+    if (texture != batchTexture) {
+        FlushQuads();
+        batchTexture = texture;
+    }
+
+    int firstVertex = static_cast<int>(batchVertices.size());
+
+    batchVertices.push_back({ { x, y }, color, { u0, v0 } });
+    batchVertices.push_back({ { x + width, y }, color, { u1, v0 } });
+    batchVertices.push_back({ { x + width, y + height }, color, { u1, v1 } });
+    batchVertices.push_back({ { x, y + height }, color, { u0, v1 } });
+
+    batchIndices.push_back(firstVertex);
+    batchIndices.push_back(firstVertex + 1);
+    batchIndices.push_back(firstVertex + 2);
+    batchIndices.push_back(firstVertex);
+    batchIndices.push_back(firstVertex + 2);
+    batchIndices.push_back(firstVertex + 3);
 }
 
+void TextManager::FlushQuads() {
+    if (batchIndices.empty())
+        return;
+
+    SDL_RenderGeometry(renderer, batchTexture, batchVertices.data(), static_cast<int>(batchVertices.size()), batchIndices.data(), static_cast<int>(batchIndices.size()));
+
+    batchVertices.clear();
+    batchIndices.clear();
+}
@@ -0,0 +1,260 @@
+#include "Tilemap.h"
+#include "ImageManager.h"
+#include "Rigidbody.h"
+#include <algorithm>
+#include <iostream>
+
+int Tilemap::GetTile(int column, int row) {
+    if (column < 0 || column >= columns || row < 0 || row >= rows)
+        return 0;
+
+    return tiles[row * columns + column];
+}
+
+int Tilemap::GetChunkCount() {
+    return static_cast<int>(chunks.size());
+}
+
+void Tilemap::OnStart() {
+    if (tileWidth <= 0 || tileHeight <= 0) {
+        std::cout << "error: tilemap " << key << " has tile size " << tileWidth << "x" << tileHeight << ", both must be positive";
+        exit(0);
+    }
+
+    if (columns <= 0 || rows <= 0 || chunkSize <= 0)
+        return;
+
+    if (static_cast<int>(tiles.size()) != columns * rows) {
+        std::cout << "error: tilemap " << key << " has " << tiles.size() << " tiles, expected " << columns * rows;
+        exit(0);
+    }
+
+    int tilesetImage = ImageManager::LoadImageHandle(tileset);
+
+    chunkColumns = (columns + chunkSize - 1) / chunkSize;
+    chunkRows = (rows + chunkSize - 1) / chunkSize;
+    chunks.reserve(chunkColumns * chunkRows);
+
+    for (int chunkRow = 0; chunkRow < chunkRows; chunkRow++) {
+        for (int chunkColumn = 0; chunkColumn < chunkColumns; chunkColumn++) {
+            TilemapChunk chunk;
+            int firstColumn = chunkColumn * chunkSize;
+            int firstRow = chunkRow * chunkSize;
+            chunk.x = x + firstColumn * tileWidth / 100.0f;
+            chunk.y = y + firstRow * tileHeight / 100.0f;
+
+            BakeChunk(chunk, firstColumn, firstRow, tilesetImage);
+
+            // Nothing to draw means nothing to collide with either
+            if (chunk.image == -1)
+                continue;
+
+            if (hasCollider)
+                BuildChunkColliders(chunk, firstColumn, firstRow);
+
+            chunks.push_back(chunk);
+        }
+    }
+}
+
+// One draw request per chunk. Chunks outside the camera view are culled by the ImageManager with everything else.
+void Tilemap::OnUpdate() {
+    for (const TilemapChunk& chunk : chunks) {
+        ImageManager::SubmitScreenSpaceExDrawRequest(chunk.image, chunk.x, chunk.y, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 255.0f, 255.0f, 255.0f, 255.0f, static_cast<float>(sortingOrder));
+    }
+}
+
+void Tilemap::OnDestroy() {
+    for (TilemapChunk& chunk : chunks) {
+        ImageManager::DestroyImage(chunk.image);
+
+        if (chunk.body != nullptr)
+            world->DestroyBody(chunk.body);
+    }
+
+    chunks.clear();
+}
+
+// Draws the chunk's tiles into its own texture. The texture is only created once a non-empty tile is found.
+void Tilemap::BakeChunk(TilemapChunk& chunk, int firstColumn, int firstRow, int tilesetImage) {
+    int lastColumn = std::min(firstColumn + chunkSize, columns);
+    int lastRow = std::min(firstRow + chunkSize, rows);
+
+    const LoadedImage& tilesetTexture = ImageManager::GetImage(tilesetImage);
+    int tilesetColumns = std::max(1, static_cast<int>(tilesetTexture.width) / tileWidth);
+
+    SDL_Renderer* renderer = ImageManager::GetRenderer();
+    SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+
+    for (int row = firstRow; row < lastRow; row++) {
+        for (int column = firstColumn; column < lastColumn; column++) {
+            int tile = tiles[row * columns + column];
+            if (tile <= 0)
+                continue;
+
+            if (chunk.image == -1) {
+                chunk.image = ImageManager::CreateTargetImage((lastColumn - firstColumn) * tileWidth, (lastRow - firstRow) * tileHeight);
+                SDL_SetRenderTarget(renderer, ImageManager::GetImage(chunk.image).texture);
+                SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+                SDL_RenderClear(renderer);
+
+                // Tiles never overlap, so copy texels as-is instead of blending them onto the cleared target
+                SDL_SetTextureBlendMode(tilesetTexture.texture, SDL_BLENDMODE_NONE);
+            }
+
+            SDL_Rect source = { ((tile - 1) % tilesetColumns) * tileWidth, ((tile - 1) / tilesetColumns) * tileHeight, tileWidth, tileHeight };
+            SDL_Rect destination = { (column - firstColumn) * tileWidth, (row - firstRow) * tileHeight, tileWidth, tileHeight };
+            SDL_RenderCopy(renderer, tilesetTexture.texture, &source, &destination);
+        }
+    }
+
+    if (chunk.image != -1) {
+        SDL_SetTextureBlendMode(tilesetTexture.texture, SDL_BLENDMODE_BLEND);
+        SDL_SetRenderTarget(renderer, previousTarget);
+    }
+}
+
+// Tiles past the chunk edge count as empty so every outline closes inside its chunk
+bool Tilemap::IsSolid(int column, int row, int firstColumn, int firstRow) {
+    if (column < firstColumn || column >= std::min(firstColumn + chunkSize, columns))
+        return false;
+    if (row < firstRow || row >= std::min(firstRow + chunkSize, rows))
+        return false;
+
+    return tiles[row * columns + column] > 0;
+}
+
+// Traces the outline of every group of solid tiles in the chunk and turns each one into a chain loop
+// on a single static body. Loops run clockwise on screen, which puts the one-sided chain normals outside.
+void Tilemap::BuildChunkColliders(TilemapChunk& chunk, int firstColumn, int firstRow) {
+    struct OutlineEdge {
+        int fromX, fromY; // Tile corner, relative to the chunk
+        int directionX, directionY;
+        bool used;
+    };
+
+    int width = std::min(chunkSize, columns - firstColumn);
+    int height = std::min(chunkSize, rows - firstRow);
+    int cornersPerRow = width + 1;
+
+    std::vector<OutlineEdge> edges;
+    std::vector<int> outgoingEdges((width + 1) * (height + 1) * 2, -1); // At most two per corner
+
+    auto addEdge = [&](int fromX, int fromY, int directionX, int directionY) {
+        int corner = (fromY * cornersPerRow + fromX) * 2;
+        outgoingEdges[outgoingEdges[corner] == -1 ? corner : corner + 1] = static_cast<int>(edges.size());
+        edges.push_back({ fromX, fromY, directionX, directionY, false });
+    };
+
+    // Every solid tile side facing an empty tile is an edge, oriented so the solid tile is on its right
+    for (int row = 0; row < height; row++) {
+        for (int column = 0; column < width; column++) {
+            int tileColumn = firstColumn + column;
+            int tileRow = firstRow + row;
+
+            if (!IsSolid(tileColumn, tileRow, firstColumn, firstRow))
+                continue;
+
+            if (!IsSolid(tileColumn, tileRow - 1, firstColumn, firstRow))
+                addEdge(column, row, 1, 0);
+            if (!IsSolid(tileColumn + 1, tileRow, firstColumn, firstRow))
+                addEdge(column + 1, row, 0, 1);
+            if (!IsSolid(tileColumn, tileRow + 1, firstColumn, firstRow))
+                addEdge(column + 1, row + 1, -1, 0);
+            if (!IsSolid(tileColumn - 1, tileRow, firstColumn, firstRow))
+                addEdge(column, row + 1, 0, -1);
+        }
+    }
+
+    if (edges.empty())
+        return;
+
+    b2BodyDef bodyDef;
+    bodyDef.type = b2_staticBody;
+    bodyDef.position.Set(chunk.x, chunk.y);
+    chunk.body = world->CreateBody(&bodyDef);
+
+    float cornerWidth = tileWidth / 100.0f;
+    float cornerHeight = tileHeight / 100.0f;
+
+    std::vector<const OutlineEdge*> outline;
+    std::vector<b2Vec2> vertices;
+
+    for (OutlineEdge& first : edges) {
+        if (first.used)
+            continue;
+
+        outline.clear();
+        OutlineEdge* edge = &first;
+
+        while (!edge->used) {
+            edge->used = true;
+            outline.push_back(edge);
+
+            int toX = edge->fromX + edge->directionX;
+            int toY = edge->fromY + edge->directionY;
+            int corner = (toY * cornersPerRow + toX) * 2;
+
+            // Two ways out only happens where tiles touch diagonally. Turning clockwise stays on the same
+            // tile group, and since each way in gets its own way out the walk always ends back at the first edge.
+            OutlineEdge* next = &edges[outgoingEdges[corner]];
+            if (outgoingEdges[corner + 1] != -1) {
+                OutlineEdge* other = &edges[outgoingEdges[corner + 1]];
+                if (other->directionX == -edge->directionY && other->directionY == edge->directionX)
+                    next = other;
+            }
+
+            edge = next;
+        }
+
+        // Keep only the corners where the outline turns
+        vertices.clear();
+        for (size_t i = 0; i < outline.size(); i++) {
+            const OutlineEdge* previous = outline[(i + outline.size() - 1) % outline.size()];
+            if (previous->directionX == outline[i]->directionX && previous->directionY == outline[i]->directionY)
+                continue;
+
+            vertices.emplace_back(outline[i]->fromX * cornerWidth, outline[i]->fromY * cornerHeight);
+        }
+
+        if (vertices.size() < 3)
+            continue;
+
+        b2ChainShape chainShape;
+        chainShape.CreateLoop(vertices.data(), static_cast<int32>(vertices.size()));
+
+        b2FixtureDef colliderFixture;
+        colliderFixture.shape = &chainShape;
+        colliderFixture.userData.pointer = reinterpret_cast<uintptr_t>(actor);
+        colliderFixture.filter.categoryBits = COLLIDERS;
+        colliderFixture.filter.maskBits = COLLIDERS;
+        colliderFixture.friction = friction;
+        colliderFixture.restitution = bounciness;
+        chunk.body->CreateFixture(&colliderFixture);
+    }
+}
+
+std::shared_ptr<Tilemap> Tilemap::Clone(Actor* actor) const {
+    auto clone = std::make_shared<Tilemap>();
+
+    clone->tileset = this->tileset;
+    clone->tileWidth = this->tileWidth;
+    clone->tileHeight = this->tileHeight;
+    clone->columns = this->columns;
+    clone->rows = this->rows;
+    clone->chunkSize = this->chunkSize;
+    clone->x = this->x;
+    clone->y = this->y;
+    clone->sortingOrder = this->sortingOrder;
+    clone->hasCollider = this->hasCollider;
+    clone->friction = this->friction;
+    clone->bounciness = this->bounciness;
+    clone->tiles = this->tiles;
+    clone->type = this->type;
+    clone->key = this->key;
+    clone->enabled = this->enabled;
+
+    clone->actor = actor;
+
+    return clone;
+}
@@ -0,0 +1,342 @@
+#include "Transform.h"
+#include "Actor.h"
+#include <algorithm>
+#include <cmath>
+
+Transform::Transform() {
+    slot = AllocateSlot();
+    owners[slot] = this;
+}
+
+Transform::Transform(const Transform& other) : Transform() {
+    *this = other;
+}
+
+Transform& Transform::operator=(const Transform& other) {
+    if (this == &other)
+        return *this;
+
+    if (slot == invalidTransformSlot) {
+        // A pooled transform was released by OnDestroy, it stays out of the arrays until Reattach
+        if (other.slot != invalidTransformSlot) {
+            resetX = localX[other.slot];
+            resetY = localY[other.slot];
+            resetRotation = localRotation[other.slot];
+            resetScaleX = localScaleX[other.slot];
+            resetScaleY = localScaleY[other.slot];
+        }
+    }
+    else {
+        if (other.slot != invalidTransformSlot) {
+            localX[slot] = localX[other.slot];
+            localY[slot] = localY[other.slot];
+            localRotation[slot] = localRotation[other.slot];
+            localScaleX[slot] = localScaleX[other.slot];
+            localScaleY[slot] = localScaleY[other.slot];
+        }
+
+        // Parents belong to other actors, copies start out as roots
+        if (parents[slot] != invalidTransformSlot) {
+            parents[slot] = invalidTransformSlot;
+            updateOrderDirty = true;
+        }
+    }
+
+    type = other.type;
+    key = other.key;
+    enabled = other.enabled;
+
+    return *this;
+}
+
+uint32_t Transform::AllocateSlot() {
+    uint32_t newSlot;
+
+    if (freeSlots.empty()) {
+        newSlot = static_cast<uint32_t>(owners.size());
+        localX.push_back(0.0f);
+        localY.push_back(0.0f);
+        localRotation.push_back(0.0f);
+        localScaleX.push_back(1.0f);
+        localScaleY.push_back(1.0f);
+        worldX.push_back(0.0f);
+        worldY.push_back(0.0f);
+        worldRotation.push_back(0.0f);
+        worldScaleX.push_back(1.0f);
+        worldScaleY.push_back(1.0f);
+        parents.push_back(invalidTransformSlot);
+        owners.push_back(nullptr);
+    }
+    else {
+        newSlot = freeSlots.back();
+        freeSlots.pop_back();
+        localX[newSlot] = worldX[newSlot] = 0.0f;
+        localY[newSlot] = worldY[newSlot] = 0.0f;
+        localRotation[newSlot] = worldRotation[newSlot] = 0.0f;
+        localScaleX[newSlot] = worldScaleX[newSlot] = 1.0f;
+        localScaleY[newSlot] = worldScaleY[newSlot] = 1.0f;
+        parents[newSlot] = invalidTransformSlot;
+    }
+
+    updateOrderDirty = true;
+    return newSlot;
+}
+
+float Transform::GetX() const {
+    return slot == invalidTransformSlot ? 0.0f : localX[slot];
+}
+
+void Transform::SetX(float value) {
+    if (slot != invalidTransformSlot)
+        localX[slot] = value;
+}
+
+float Transform::GetY() const {
+    return slot == invalidTransformSlot ? 0.0f : localY[slot];
+}
+
+void Transform::SetY(float value) {
+    if (slot != invalidTransformSlot)
+        localY[slot] = value;
+}
+
+float Transform::GetRotation() const {
+    return slot == invalidTransformSlot ? 0.0f : localRotation[slot];
+}
+
+void Transform::SetRotation(float degreesClockwise) {
+    if (slot != invalidTransformSlot)
+        localRotation[slot] = degreesClockwise;
+}
+
+float Transform::GetScaleX() const {
+    return slot == invalidTransformSlot ? 1.0f : localScaleX[slot];
+}
+
+void Transform::SetScaleX(float value) {
+    if (slot != invalidTransformSlot)
+        localScaleX[slot] = value;
+}
+
+float Transform::GetScaleY() const {
+    return slot == invalidTransformSlot ? 1.0f : localScaleY[slot];
+}
+
+void Transform::SetScaleY(float value) {
+    if (slot != invalidTransformSlot)
+        localScaleY[slot] = value;
+}
+
+b2Vec2 Transform::GetPosition() const {
+    return b2Vec2(GetX(), GetY());
+}
+
+void Transform::SetPosition(b2Vec2 position) {
+    SetX(position.x);
+    SetY(position.y);
+}
+
+b2Vec2 Transform::GetWorldPosition() const {
+    if (slot == invalidTransformSlot)
+        return b2Vec2(0.0f, 0.0f);
+
+    return b2Vec2(worldX[slot], worldY[slot]);
+}
+
+float Transform::GetWorldRotation() const {
+    return slot == invalidTransformSlot ? 0.0f : worldRotation[slot];
+}
+
+b2Vec2 Transform::GetWorldScale() const {
+    if (slot == invalidTransformSlot)
+        return b2Vec2(1.0f, 1.0f);
+
+    return b2Vec2(worldScaleX[slot], worldScaleY[slot]);
+}
+
+void Transform::SetWorldPose(b2Vec2 position, float degreesClockwise) {
+    if (slot == invalidTransformSlot)
+        return;
+
+    uint32_t parent = parents[slot];
+    if (parent == invalidTransformSlot) {
+        localX[slot] = position.x;
+        localY[slot] = position.y;
+        localRotation[slot] = degreesClockwise;
+        return;
+    }
+
+    // UpdateWorldTransforms backwards: remove the parent's translation, rotate back, then unscale.
+    // An axis the parent scales to zero can't be inverted, so it keeps its local value.
+    float radians = worldRotation[parent] * (b2_pi / 180.0f);
+    float cosine = std::cos(radians);
+    float sine = std::sin(radians);
+    float offsetX = position.x - worldX[parent];
+    float offsetY = position.y - worldY[parent];
+    float rotatedX = offsetX * cosine + offsetY * sine;
+    float rotatedY = offsetY * cosine - offsetX * sine;
+
+    if (worldScaleX[parent] != 0.0f)
+        localX[slot] = rotatedX / worldScaleX[parent];
+    if (worldScaleY[parent] != 0.0f)
+        localY[slot] = rotatedY / worldScaleY[parent];
+    localRotation[slot] = degreesClockwise - worldRotation[parent];
+}
+
+bool Transform::IsAncestor(uint32_t ancestor, uint32_t descendant) {
+    for (uint32_t s = descendant; s != invalidTransformSlot; s = parents[s]) {
+        if (s == ancestor)
+            return true;
+    }
+
+    return false;
+}
+
+// Parenting a transform to itself or to one of its own children is ignored
+void Transform::SetParent(Transform* parent) {
+    if (slot == invalidTransformSlot)
+        return;
+
+    uint32_t parentSlot = parent == nullptr ? invalidTransformSlot : parent->slot;
+    if (parentSlot != invalidTransformSlot && IsAncestor(slot, parentSlot))
+        return;
+
+    parents[slot] = parentSlot;
+    updateOrderDirty = true;
+}
+
+Transform* Transform::GetParent() const {
+    if (slot == invalidTransformSlot || parents[slot] == invalidTransformSlot)
+        return nullptr;
+
+    return owners[parents[slot]];
+}
+
+// Children of a destroyed transform become roots at their local position. Also called by SceneManager when the
+// actor leaves the scene, so it may run twice.
+void Transform::OnDestroy() {
+    if (slot == invalidTransformSlot)
+        return;
+
+    owners[slot] = nullptr;
+    releasedSlots.push_back(slot);
+    slot = invalidTransformSlot;
+    updateOrderDirty = true;
+}
+
+// Reattached transforms are roots, so their world values start out equal to the local ones
+void Transform::Reattach() {
+    if (slot != invalidTransformSlot)
+        return;
+
+    slot = AllocateSlot();
+    owners[slot] = this;
+    localX[slot] = worldX[slot] = resetX;
+    localY[slot] = worldY[slot] = resetY;
+    localRotation[slot] = worldRotation[slot] = resetRotation;
+    localScaleX[slot] = worldScaleX[slot] = resetScaleX;
+    localScaleY[slot] = worldScaleY[slot] = resetScaleY;
+}
+
+// Counting sort of the live slots by depth. Only runs on frames where the hierarchy changed.
+void Transform::RebuildUpdateOrder() {
+    // Detach children of released slots before the slots can be handed out again
+    if (!releasedSlots.empty()) {
+        for (uint32_t& parent : parents) {
+            if (parent != invalidTransformSlot && owners[parent] == nullptr)
+                parent = invalidTransformSlot;
+        }
+
+        freeSlots.insert(std::end(freeSlots), std::begin(releasedSlots), std::end(releasedSlots));
+        releasedSlots.clear();
+    }
+
+    uint32_t numSlots = static_cast<uint32_t>(owners.size());
+    depths.assign(numSlots, invalidTransformSlot);
+    uint32_t maxDepth = 0;
+
+    for (uint32_t s = 0; s < numSlots; s++) {
+        if (owners[s] == nullptr || depths[s] != invalidTransformSlot)
+            continue;
+
+        // Walk up to the first slot with a known depth, then fill in the depths on the way back down
+        uint32_t depth = 0;
+        uint32_t top = s;
+        while (parents[top] != invalidTransformSlot && depths[parents[top]] == invalidTransformSlot) {
+            top = parents[top];
+            depth++;
+        }
+        uint32_t baseDepth = parents[top] == invalidTransformSlot ? 0 : depths[parents[top]] + 1;
+
+        for (uint32_t walk = s; ; walk = parents[walk]) {
+            depths[walk] = baseDepth + depth;
+            maxDepth = std::max(maxDepth, depths[walk]);
+            if (walk == top)
+                break;
+            depth--;
+        }
+    }
+
+    std::vector<uint32_t> offsets(maxDepth + 2, 0);
+    for (uint32_t s = 0; s < numSlots; s++) {
+        if (owners[s] != nullptr)
+            offsets[depths[s] + 1]++;
+    }
+    for (size_t d = 1; d < offsets.size(); d++) {
+        offsets[d] += offsets[d - 1];
+    }
+
+    updateOrder.resize(offsets.back());
+    for (uint32_t s = 0; s < numSlots; s++) {
+        if (owners[s] != nullptr)
+            updateOrder[offsets[depths[s]]++] = s;
+    }
+
+    updateOrderDirty = false;
+}
+
+void Transform::UpdateWorldTransforms() {
+    if (updateOrderDirty)
+        RebuildUpdateOrder();
+
+    for (uint32_t s : updateOrder) {
+        uint32_t parent = parents[s];
+
+        if (parent == invalidTransformSlot) {
+            worldX[s] = localX[s];
+            worldY[s] = localY[s];
+            worldRotation[s] = localRotation[s];
+            worldScaleX[s] = localScaleX[s];
+            worldScaleY[s] = localScaleY[s];
+            continue;
+        }
+
+        // Scale and rotate the local offset by the parent, then translate. Same as multiplying the
+        // parent's world matrix by the local one, without building either matrix.
+        float radians = worldRotation[parent] * (b2_pi / 180.0f);
+        float cosine = std::cos(radians);
+        float sine = std::sin(radians);
+        float offsetX = localX[s] * worldScaleX[parent];
+        float offsetY = localY[s] * worldScaleY[parent];
+
+        worldX[s] = worldX[parent] + offsetX * cosine - offsetY * sine;
+        worldY[s] = worldY[parent] + offsetX * sine + offsetY * cosine;
+        worldRotation[s] = worldRotation[parent] + localRotation[s];
+        worldScaleX[s] = worldScaleX[parent] * localScaleX[s];
+        worldScaleY[s] = worldScaleY[parent] * localScaleY[s];
+    }
+}
+
+Transform* Transform::GetActorTransform(Actor* actor) {
+    luabridge::LuaRef component = actor->GetComponent("Transform");
+    return component.isNil() ? nullptr : component.cast<Transform*>();
+}
+
+std::shared_ptr<Transform> Transform::Clone(Actor* actor) const {
+    auto clone = std::make_shared<Transform>();
+
+    *clone = *this;
+    clone->actor = actor;
+
+    return clone;
+}
@@ -34,6 +34,9 @@ b2BroadPhase::b2BroadPhase()
 	m_moveCapacity = 16;
 	m_moveCount = 0;
 	m_moveBuffer = (int32*)b2Alloc(m_moveCapacity * sizeof(int32));
+
+	m_queryProxyId = e_nullProxy;
+	m_queryTreeFlag = 0;
 }
 
 b2BroadPhase::~b2BroadPhase()
@@ -42,10 +45,24 @@ b2BroadPhase::~b2BroadPhase()
 	b2Free(m_pairBuffer);
 }
 
-int32 b2BroadPhase::CreateProxy(const b2AABB& aabb, void* userData)
+int32 b2BroadPhase::CreateProxy(const b2AABB& aabb, void* userData, bool staticProxy)
 {
-	int32 proxyId = m_tree.CreateProxy(aabb, userData);
+	int32 proxyId;
+	if (staticProxy)
+	{
+		proxyId = m_staticTree.CreateProxy(aabb, userData);
+		b2Assert(proxyId < e_staticProxyFlag);
+		proxyId |= e_staticProxyFlag;
+	}
+	else
+	{
+		proxyId = m_dynamicTree.CreateProxy(aabb, userData);
+		b2Assert(proxyId < e_staticProxyFlag);
+	}
+
 	++m_proxyCount;
+
+	// A new static proxy still has to find the moving proxies already overlapping it.
 	BufferMove(proxyId);
 	return proxyId;
 }
@@ -54,12 +71,12 @@ void b2BroadPhase::DestroyProxy(int32 proxyId)
 {
 	UnBufferMove(proxyId);
 	--m_proxyCount;
-	m_tree.DestroyProxy(proxyId);
+	GetTree(proxyId).DestroyProxy(GetTreeProxyId(proxyId));
 }
 
 void b2BroadPhase::MoveProxy(int32 proxyId, const b2AABB& aabb, const b2Vec2& displacement)
 {
-	bool buffer = m_tree.MoveProxy(proxyId, aabb, displacement);
+	bool buffer = GetTree(proxyId).MoveProxy(GetTreeProxyId(proxyId), aabb, displacement);
 	if (buffer)
 	{
 		BufferMove(proxyId);
@@ -100,16 +117,21 @@ void b2BroadPhase::UnBufferMove(int32 proxyId)
 // This is called from b2DynamicTree::Query when we are gathering pairs.
 bool b2BroadPhase::QueryCallback(int32 proxyId)
 {
+	// The tree hands out its own ids.
+	proxyId |= m_queryTreeFlag;
+
 	// A proxy cannot form a pair with itself.
 	if (proxyId == m_queryProxyId)
 	{
 		return true;
 	}
 
-	const bool moved = m_tree.WasMoved(proxyId);
+	const bool moved = GetTree(proxyId).WasMoved(GetTreeProxyId(proxyId));
 	if (moved && proxyId > m_queryProxyId)
 	{
-		// Both proxies are moving. Avoid duplicate pairs.
+		// Both proxies are moving. Avoid duplicate pairs. Static ids sort after
+		// dynamic ones, so a moved static proxy found here is left to its own
+		// query of the dynamic tree.
 		return true;
 	}
 
@@ -123,8 +145,18 @@ bool b2BroadPhase::QueryCallback(int32 proxyId)
 		b2Free(oldBuffer);
 	}
 
-	m_pairBuffer[m_pairCount].proxyIdA = b2Min(proxyId, m_queryProxyId);
-	m_pairBuffer[m_pairCount].proxyIdB = b2Max(proxyId, m_queryProxyId);
+	int32 proxyIdA = b2Min(proxyId, m_queryProxyId);
+	int32 proxyIdB = b2Max(proxyId, m_queryProxyId);
+
+	// Static proxies go first. b2ContactManager::AddPair searches the contacts of the second
+	// proxy's body, and a level body can have thousands of them.
+	if (IsStaticProxy(proxyIdB))
+	{
+		b2Swap(proxyIdA, proxyIdB);
+	}
+
+	m_pairBuffer[m_pairCount].proxyIdA = proxyIdA;
+	m_pairBuffer[m_pairCount].proxyIdB = proxyIdB;
 	++m_pairCount;
 
 	return true;
@@ -790,6 +790,234 @@ void b2DynamicTree::RebuildBottomUp()
 	Validate();
 }
 
+// Number of buckets the leaf centers are sorted into when looking for a split.
+#define b2_treeBinCount 16
+
+// A range of leaves waiting to become a subtree of the given parent.
+struct b2TreeBuildTask
+{
+	int32 start;
+	int32 count;
+	int32 parent;
+	bool isChild1;
+};
+
+static int32 b2GetTreeBin(const b2Vec2& center, int32 axis, float lower, float scale)
+{
+	int32 bin = int32(scale * (center(axis) - lower));
+	return b2Min(bin, b2_treeBinCount - 1);
+}
+
+// Reorders the leaves so the first child comes first and returns its size. The split plane is the
+// bin boundary along the longer axis of the centers that minimizes the summed child perimeters,
+// each weighted by its leaf count.
+static int32 b2PartitionLeaves(const b2TreeNode* nodes, int32* leaves, b2Vec2* centers, int32 count)
+{
+	b2Vec2 lower = centers[0];
+	b2Vec2 upper = centers[0];
+	for (int32 i = 1; i < count; ++i)
+	{
+		lower = b2Min(lower, centers[i]);
+		upper = b2Max(upper, centers[i]);
+	}
+
+	b2Vec2 extent = upper - lower;
+	int32 axis = extent.x >= extent.y ? 0 : 1;
+	if (extent(axis) <= 0.0f)
+	{
+		// All centers coincide, any split is as good as another.
+		return count / 2;
+	}
+
+	float scale = b2_treeBinCount / extent(axis);
+
+	b2AABB binAABBs[b2_treeBinCount];
+	int32 binCounts[b2_treeBinCount] = {};
+	for (int32 i = 0; i < count; ++i)
+	{
+		int32 bin = b2GetTreeBin(centers[i], axis, lower(axis), scale);
+		const b2AABB& aabb = nodes[leaves[i]].aabb;
+		if (binCounts[bin] == 0)
+		{
+			binAABBs[bin] = aabb;
+		}
+		else
+		{
+			binAABBs[bin].Combine(aabb);
+		}
+		++binCounts[bin];
+	}
+
+	// Sweep from the right for the cost of every possible second child.
+	float rightCosts[b2_treeBinCount];
+	b2AABB aabb = nodes[leaves[0]].aabb;
+	int32 n = 0;
+	for (int32 bin = b2_treeBinCount - 1; bin > 0; --bin)
+	{
+		if (binCounts[bin] > 0)
+		{
+			if (n == 0)
+			{
+				aabb = binAABBs[bin];
+			}
+			else
+			{
+				aabb.Combine(binAABBs[bin]);
+			}
+			n += binCounts[bin];
+		}
+
+		rightCosts[bin] = n > 0 ? n * aabb.GetPerimeter() : 0.0f;
+	}
+
+	// Then from the left, pairing each first child with the second child stored above.
+	float bestCost = b2_maxFloat;
+	int32 bestBin = -1;
+	n = 0;
+	for (int32 bin = 0; bin < b2_treeBinCount - 1; ++bin)
+	{
+		if (binCounts[bin] > 0)
+		{
+			if (n == 0)
+			{
+				aabb = binAABBs[bin];
+			}
+			else
+			{
+				aabb.Combine(binAABBs[bin]);
+			}
+			n += binCounts[bin];
+		}
+
+		if (n == 0 || n == count)
+		{
+			continue;
+		}
+
+		float cost = n * aabb.GetPerimeter() + rightCosts[bin + 1];
+		if (cost < bestCost)
+		{
+			bestCost = cost;
+			bestBin = bin;
+		}
+	}
+
+	b2Assert(bestBin >= 0);
+
+	int32 i = 0;
+	int32 j = count - 1;
+	while (i <= j)
+	{
+		if (b2GetTreeBin(centers[i], axis, lower(axis), scale) <= bestBin)
+		{
+			++i;
+		}
+		else
+		{
+			b2Swap(leaves[i], leaves[j]);
+			b2Swap(centers[i], centers[j]);
+			--j;
+		}
+	}
+
+	return i;
+}
+
+void b2DynamicTree::RebuildTopDown()
+{
+	if (m_root == b2_nullNode)
+	{
+		return;
+	}
+
+	int32* leaves = (int32*)b2Alloc(m_nodeCount * sizeof(int32));
+	b2Vec2* centers = (b2Vec2*)b2Alloc(m_nodeCount * sizeof(b2Vec2));
+	int32 count = 0;
+
+	// Build array of leaves. Free the rest.
+	for (int32 i = 0; i < m_nodeCapacity; ++i)
+	{
+		if (m_nodes[i].height < 0)
+		{
+			// free node in pool
+			continue;
+		}
+
+		if (m_nodes[i].IsLeaf())
+		{
+			leaves[count] = i;
+			centers[count] = m_nodes[i].aabb.GetCenter();
+			++count;
+		}
+		else
+		{
+			FreeNode(i);
+		}
+	}
+
+	// A binary tree over count leaves has count - 1 internal nodes.
+	int32* internalNodes = (int32*)b2Alloc(count * sizeof(int32));
+	int32 internalCount = 0;
+
+	// Iterative, since a clustered level can make the splits lopsided and the recursion deep.
+	b2GrowableStack<b2TreeBuildTask, 64> stack;
+	b2TreeBuildTask root = { 0, count, b2_nullNode, true };
+	stack.Push(root);
+
+	while (stack.GetCount() > 0)
+	{
+		b2TreeBuildTask task = stack.Pop();
+
+		int32 nodeId;
+		if (task.count == 1)
+		{
+			nodeId = leaves[task.start];
+		}
+		else
+		{
+			int32 split = b2PartitionLeaves(m_nodes, leaves + task.start, centers + task.start, task.count);
+			nodeId = AllocateNode();
+			internalNodes[internalCount] = nodeId;
+			++internalCount;
+
+			b2TreeBuildTask child2 = { task.start + split, task.count - split, nodeId, false };
+			b2TreeBuildTask child1 = { task.start, split, nodeId, true };
+			stack.Push(child2);
+			stack.Push(child1);
+		}
+
+		m_nodes[nodeId].parent = task.parent;
+		if (task.parent == b2_nullNode)
+		{
+			m_root = nodeId;
+		}
+		else if (task.isChild1)
+		{
+			m_nodes[task.parent].child1 = nodeId;
+		}
+		else
+		{
+			m_nodes[task.parent].child2 = nodeId;
+		}
+	}
+
+	// Parents were allocated before their children, so going backwards reaches every node after its children.
+	for (int32 i = internalCount - 1; i >= 0; --i)
+	{
+		b2TreeNode* node = m_nodes + internalNodes[i];
+		const b2TreeNode* child1 = m_nodes + node->child1;
+		const b2TreeNode* child2 = m_nodes + node->child2;
+		node->height = 1 + b2Max(child1->height, child2->height);
+		node->aabb.Combine(child1->aabb, child2->aabb);
+	}
+
+	b2Free(internalNodes);
+	b2Free(centers);
+	b2Free(leaves);
+
+	Validate();
+}
+
 void b2DynamicTree::ShiftOrigin(const b2Vec2& newOrigin)
 {
 	// Build array of leaves. Free the rest.
@@ -0,0 +1,114 @@
+#include "box2d/b2_thread_pool.h"
+#include "box2d/b2_stack_allocator.h"
+
+b2ThreadPool::b2ThreadPool(int32 workerCount)
+{
+	b2Assert(workerCount >= 0);
+
+	m_generation = 0;
+	m_busyWorkers = 0;
+	m_quit = false;
+	m_task = nullptr;
+	m_context = nullptr;
+	m_taskCount = 0;
+	m_nextIndex = 0;
+
+	// b2StackAllocator keeps its buffer inline, too big to hold by value in a vector
+	for (int32 i = 0; i <= workerCount; ++i)
+	{
+		m_allocators.push_back(new b2StackAllocator());
+	}
+
+	for (int32 i = 1; i <= workerCount; ++i)
+	{
+		m_threads.emplace_back(&b2ThreadPool::WorkerMain, this, i);
+	}
+}
+
+b2ThreadPool::~b2ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_quit = true;
+	}
+	m_wake.notify_all();
+
+	for (std::thread& thread : m_threads)
+	{
+		thread.join();
+	}
+
+	for (b2StackAllocator* allocator : m_allocators)
+	{
+		delete allocator;
+	}
+}
+
+void b2ThreadPool::ParallelFor(int32 count, b2ParallelTask* task, void* context)
+{
+	if (m_threads.empty() || count <= 1)
+	{
+		for (int32 i = 0; i < count; ++i)
+		{
+			task(context, i, 0);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_task = task;
+		m_context = context;
+		m_taskCount = count;
+		m_nextIndex.store(0, std::memory_order_relaxed);
+		m_busyWorkers = GetWorkerCount();
+		++m_generation;
+	}
+	m_wake.notify_all();
+
+	RunTasks(0);
+
+	// Taking the mutex here also makes everything the workers wrote visible to the caller
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_done.wait(lock, [this] { return m_busyWorkers == 0; });
+}
+
+void b2ThreadPool::WorkerMain(int32 threadIndex)
+{
+	uint32 generation = 0;
+
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wake.wait(lock, [this, generation] { return m_quit || m_generation != generation; });
+			if (m_quit)
+			{
+				return;
+			}
+			generation = m_generation;
+		}
+
+		RunTasks(threadIndex);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (--m_busyWorkers == 0)
+		{
+			m_done.notify_one();
+		}
+	}
+}
+
+void b2ThreadPool::RunTasks(int32 threadIndex)
+{
+	for (;;)
+	{
+		int32 index = m_nextIndex.fetch_add(1, std::memory_order_relaxed);
+		if (index >= m_taskCount)
+		{
+			return;
+		}
+
+		m_task(m_context, index, threadIndex);
+	}
+}
@@ -121,6 +121,7 @@ void b2Body::SetType(b2BodyType type)
 		return;
 	}
 
+	bool wasStatic = m_type == b2_staticBody;
 	m_type = type;
 
 	ResetMassData();
@@ -150,8 +151,22 @@ void b2Body::SetType(b2BodyType type)
 	}
 	m_contactList = nullptr;
 
-	// Touch the proxies so that new contacts will be created (when appropriate)
 	b2BroadPhase* broadPhase = &m_world->m_contactManager.m_broadPhase;
+	if (wasStatic != (m_type == b2_staticBody))
+	{
+		// Static proxies have their own tree. Recreated proxies are buffered like touched ones.
+		if (IsEnabled())
+		{
+			for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
+			{
+				f->DestroyProxies(broadPhase);
+				f->CreateProxies(broadPhase, m_xf);
+			}
+		}
+		return;
+	}
+
+	// Touch the proxies so that new contacts will be created (when appropriate)
 	for (b2Fixture* f = m_fixtureList; f; f = f->m_next)
 	{
 		int32 proxyCount = f->m_proxyCount;
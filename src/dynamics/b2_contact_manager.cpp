@@ -24,8 +24,12 @@
 #include "box2d/b2_contact.h"
 #include "box2d/b2_contact_manager.h"
 #include "box2d/b2_fixture.h"
+#include "box2d/b2_thread_pool.h"
 #include "box2d/b2_world_callbacks.h"
 
+// Contacts per narrowphase task, enough that handing out tasks costs little next to the collision tests
+static const int32 b2_narrowphaseBatchSize = 64;
+
 b2ContactFilter b2_defaultFilter;
 b2ContactListener b2_defaultListener;
 
@@ -36,6 +40,7 @@ b2ContactManager::b2ContactManager()
 	m_contactFilter = &b2_defaultFilter;
 	m_contactListener = &b2_defaultListener;
 	m_allocator = nullptr;
+	m_threadPool = nullptr;
 }
 
 void b2ContactManager::Destroy(b2Contact* c)
@@ -106,8 +111,14 @@ void b2ContactManager::Destroy(b2Contact* c)
 // This is the top level collision call for the time step. Here
 // all the narrow phase collision is processed for the world
 // contact list.
+// Filtering and destroying contacts walks the list on the calling thread. The contacts that persist
+// are gathered into an array and their manifolds updated in batches, on the thread pool when there
+// is one. Touch changes then wake bodies and reach the listener in list order, as if the contacts
+// had been updated one after the other.
 void b2ContactManager::Collide()
 {
+	m_narrowphase.clear();
+
 	// Update awake contacts.
 	b2Contact* c = m_contactList;
 	while (c)
@@ -168,9 +179,45 @@ void b2ContactManager::Collide()
 		}
 
 		// The contact persists.
-		c->Update(m_contactListener);
+		b2NarrowphaseContact update;
+		update.contact = c;
+		m_narrowphase.push_back(update);
 		c = c->GetNext();
 	}
+
+	int32 count = int32(m_narrowphase.size());
+	int32 batchCount = (count + b2_narrowphaseBatchSize - 1) / b2_narrowphaseBatchSize;
+	if (m_threadPool != nullptr)
+	{
+		m_threadPool->ParallelFor(batchCount, &b2ContactManager::UpdateManifoldsTask, this);
+	}
+	else
+	{
+		for (int32 i = 0; i < batchCount; ++i)
+		{
+			UpdateManifoldsTask(this, i, 0);
+		}
+	}
+
+	for (const b2NarrowphaseContact& update : m_narrowphase)
+	{
+		update.contact->ReportUpdate(m_contactListener, update.oldManifold, update.wasTouching);
+	}
+}
+
+void b2ContactManager::UpdateManifoldsTask(void* context, int32 index, int32 threadIndex)
+{
+	B2_NOT_USED(threadIndex);
+
+	b2ContactManager* manager = (b2ContactManager*)context;
+	int32 begin = index * b2_narrowphaseBatchSize;
+	int32 end = b2Min(begin + b2_narrowphaseBatchSize, int32(manager->m_narrowphase.size()));
+
+	for (int32 i = begin; i < end; ++i)
+	{
+		b2NarrowphaseContact& update = manager->m_narrowphase[i];
+		update.contact->UpdateManifold(&update.oldManifold, &update.wasTouching);
+	}
 }
 
 void b2ContactManager::FindNewContacts()
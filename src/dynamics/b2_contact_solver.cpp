@@ -48,6 +48,95 @@ struct b2ContactPositionConstraint
 	int32 pointCount;
 };
 
+// Four lanes of floats for the wide solver. SSE2 and NEON where available, plain arrays otherwise.
+// Masks are lanes with every bit set (or 1.0f without SIMD) and only feed b2AndW and b2BlendW.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+
+#include <emmintrin.h>
+
+typedef __m128 b2FloatW;
+
+static inline b2FloatW b2LoadW(const float* p) { return _mm_loadu_ps(p); }
+static inline void b2StoreW(float* p, b2FloatW a) { _mm_storeu_ps(p, a); }
+static inline b2FloatW b2SplatW(float s) { return _mm_set1_ps(s); }
+static inline b2FloatW b2AddW(b2FloatW a, b2FloatW b) { return _mm_add_ps(a, b); }
+static inline b2FloatW b2SubW(b2FloatW a, b2FloatW b) { return _mm_sub_ps(a, b); }
+static inline b2FloatW b2MulW(b2FloatW a, b2FloatW b) { return _mm_mul_ps(a, b); }
+static inline b2FloatW b2MaxW(b2FloatW a, b2FloatW b) { return _mm_max_ps(a, b); }
+static inline b2FloatW b2MinW(b2FloatW a, b2FloatW b) { return _mm_min_ps(a, b); }
+static inline b2FloatW b2GreaterEqualW(b2FloatW a, b2FloatW b) { return _mm_cmpge_ps(a, b); }
+static inline b2FloatW b2AndW(b2FloatW a, b2FloatW b) { return _mm_and_ps(a, b); }
+static inline b2FloatW b2BlendW(b2FloatW a, b2FloatW b, b2FloatW mask) { return _mm_or_ps(_mm_and_ps(mask, b), _mm_andnot_ps(mask, a)); }
+
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+
+#include <arm_neon.h>
+
+typedef float32x4_t b2FloatW;
+
+static inline b2FloatW b2LoadW(const float* p) { return vld1q_f32(p); }
+static inline void b2StoreW(float* p, b2FloatW a) { vst1q_f32(p, a); }
+static inline b2FloatW b2SplatW(float s) { return vdupq_n_f32(s); }
+static inline b2FloatW b2AddW(b2FloatW a, b2FloatW b) { return vaddq_f32(a, b); }
+static inline b2FloatW b2SubW(b2FloatW a, b2FloatW b) { return vsubq_f32(a, b); }
+static inline b2FloatW b2MulW(b2FloatW a, b2FloatW b) { return vmulq_f32(a, b); }
+static inline b2FloatW b2MaxW(b2FloatW a, b2FloatW b) { return vmaxq_f32(a, b); }
+static inline b2FloatW b2MinW(b2FloatW a, b2FloatW b) { return vminq_f32(a, b); }
+static inline b2FloatW b2GreaterEqualW(b2FloatW a, b2FloatW b) { return vreinterpretq_f32_u32(vcgeq_f32(a, b)); }
+static inline b2FloatW b2AndW(b2FloatW a, b2FloatW b) { return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b))); }
+static inline b2FloatW b2BlendW(b2FloatW a, b2FloatW b, b2FloatW mask) { return vbslq_f32(vreinterpretq_u32_f32(mask), b, a); }
+
+#else
+
+struct b2FloatW
+{
+	float v[4];
+};
+
+static inline b2FloatW b2LoadW(const float* p) { return { { p[0], p[1], p[2], p[3] } }; }
+static inline void b2StoreW(float* p, b2FloatW a) { for (int32 i = 0; i < 4; ++i) { p[i] = a.v[i]; } }
+static inline b2FloatW b2SplatW(float s) { return { { s, s, s, s } }; }
+static inline b2FloatW b2AddW(b2FloatW a, b2FloatW b) { for (int32 i = 0; i < 4; ++i) { a.v[i] += b.v[i]; } return a; }
+static inline b2FloatW b2SubW(b2FloatW a, b2FloatW b) { for (int32 i = 0; i < 4; ++i) { a.v[i] -= b.v[i]; } return a; }
+static inline b2FloatW b2MulW(b2FloatW a, b2FloatW b) { for (int32 i = 0; i < 4; ++i) { a.v[i] *= b.v[i]; } return a; }
+static inline b2FloatW b2MaxW(b2FloatW a, b2FloatW b) { for (int32 i = 0; i < 4; ++i) { a.v[i] = b2Max(a.v[i], b.v[i]); } return a; }
+static inline b2FloatW b2MinW(b2FloatW a, b2FloatW b) { for (int32 i = 0; i < 4; ++i) { a.v[i] = b2Min(a.v[i], b.v[i]); } return a; }
+static inline b2FloatW b2GreaterEqualW(b2FloatW a, b2FloatW b) { for (int32 i = 0; i < 4; ++i) { a.v[i] = a.v[i] >= b.v[i] ? 1.0f : 0.0f; } return a; }
+static inline b2FloatW b2AndW(b2FloatW a, b2FloatW b) { for (int32 i = 0; i < 4; ++i) { a.v[i] = a.v[i] != 0.0f && b.v[i] != 0.0f ? 1.0f : 0.0f; } return a; }
+static inline b2FloatW b2BlendW(b2FloatW a, b2FloatW b, b2FloatW mask) { for (int32 i = 0; i < 4; ++i) { a.v[i] = mask.v[i] != 0.0f ? b.v[i] : a.v[i]; } return a; }
+
+#endif
+
+const int32 b2_wideLanes = 4;
+
+// Colors available to the wide solver, one bit each in the per body masks used while coloring
+const int32 b2_wideColorCount = 16;
+
+// Four velocity constraints laid out lane by lane. Single point constraints leave the second point zeroed.
+struct b2ContactConstraintWide
+{
+	int32 constraintIndex[b2_wideLanes];
+	int32 indexA[b2_wideLanes];
+	int32 indexB[b2_wideLanes];
+	float invMassA[b2_wideLanes], invIA[b2_wideLanes];
+	float invMassB[b2_wideLanes], invIB[b2_wideLanes];
+	float normalX[b2_wideLanes], normalY[b2_wideLanes];
+	float friction[b2_wideLanes];
+	float tangentSpeed[b2_wideLanes];
+	float rA1X[b2_wideLanes], rA1Y[b2_wideLanes], rB1X[b2_wideLanes], rB1Y[b2_wideLanes];
+	float rA2X[b2_wideLanes], rA2Y[b2_wideLanes], rB2X[b2_wideLanes], rB2Y[b2_wideLanes];
+	float normalMass1[b2_wideLanes], normalMass2[b2_wideLanes];
+	float tangentMass1[b2_wideLanes], tangentMass2[b2_wideLanes];
+	float velocityBias1[b2_wideLanes], velocityBias2[b2_wideLanes];
+	float normalImpulse1[b2_wideLanes], normalImpulse2[b2_wideLanes];
+	float tangentImpulse1[b2_wideLanes], tangentImpulse2[b2_wideLanes];
+
+	// Block solver, K and its inverse are symmetric
+	float blockSolve[b2_wideLanes];
+	float k11[b2_wideLanes], k12[b2_wideLanes], k22[b2_wideLanes];
+	float blockMass11[b2_wideLanes], blockMass12[b2_wideLanes], blockMass22[b2_wideLanes];
+};
+
 b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 {
 	m_step = def->step;
@@ -58,6 +147,10 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 	m_positions = def->positions;
 	m_velocities = def->velocities;
 	m_contacts = def->contacts;
+	m_wideConstraints = nullptr;
+	m_wideCount = 0;
+	m_scalarIndices = nullptr;
+	m_scalarCount = 0;
 
 	// Initialize position independent portions of the constraints.
 	for (int32 i = 0; i < m_count; ++i)
@@ -134,10 +227,23 @@ b2ContactSolver::b2ContactSolver(b2ContactSolverDef* def)
 			pc->localPoints[j] = cp->localPoint;
 		}
 	}
+
+	// Below a couple of batches the scalar solver is just as fast. The wide solver only has the block solver for
+	// two point constraints.
+	if (m_step.wideContacts && g_blockSolve && m_count >= 2 * b2_wideLanes)
+	{
+		ColorConstraints();
+	}
 }
 
 b2ContactSolver::~b2ContactSolver()
 {
+	// Warning: the order should reverse the constructor order.
+	if (m_wideConstraints != nullptr)
+	{
+		m_allocator->Free(m_scalarIndices);
+		m_allocator->Free(m_wideConstraints);
+	}
 	m_allocator->Free(m_velocityConstraints);
 	m_allocator->Free(m_positionConstraints);
 }
@@ -252,6 +358,175 @@ void b2ContactSolver::InitializeVelocityConstraints()
 			}
 		}
 	}
+
+	if (m_wideConstraints != nullptr)
+	{
+		PrepareWideConstraints();
+	}
+}
+
+// Greedy graph coloring. Each constraint takes the lowest color that neither of its dynamic bodies has
+// used yet. Static and kinematic bodies are never written by the solver, so any number of constraints
+// in a color can share them. Each color is then cut into batches of b2_wideLanes constraints, keeping
+// the original order; leftovers and constraints that found no free color go to the scalar solver.
+void b2ContactSolver::ColorConstraints()
+{
+	m_wideConstraints = (b2ContactConstraintWide*)m_allocator->Allocate((m_count / b2_wideLanes) * sizeof(b2ContactConstraintWide));
+	m_scalarIndices = (int32*)m_allocator->Allocate(m_count * sizeof(int32));
+
+	int32 bodyCount = 0;
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		const b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+		bodyCount = b2Max(bodyCount, b2Max(vc->indexA, vc->indexB) + 1);
+	}
+
+	uint16* bodyColors = (uint16*)m_allocator->Allocate(bodyCount * sizeof(uint16));
+	memset(bodyColors, 0, bodyCount * sizeof(uint16));
+
+	// Color of each constraint in m_scalarIndices for now, b2_wideColorCount when there was none left
+	int32* colors = (int32*)m_allocator->Allocate(m_count * sizeof(int32));
+	int32 colorCounts[b2_wideColorCount + 1] = {};
+
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		const b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+		bool dynamicA = vc->invMassA > 0.0f || vc->invIA > 0.0f;
+		bool dynamicB = vc->invMassB > 0.0f || vc->invIB > 0.0f;
+
+		uint32 used = 0;
+		if (dynamicA)
+		{
+			used |= bodyColors[vc->indexA];
+		}
+		if (dynamicB)
+		{
+			used |= bodyColors[vc->indexB];
+		}
+
+		int32 color = 0;
+		while (color < b2_wideColorCount && (used & (1u << color)) != 0)
+		{
+			++color;
+		}
+
+		if (color < b2_wideColorCount)
+		{
+			if (dynamicA)
+			{
+				bodyColors[vc->indexA] |= uint16(1u << color);
+			}
+			if (dynamicB)
+			{
+				bodyColors[vc->indexB] |= uint16(1u << color);
+			}
+		}
+
+		colors[i] = color;
+		++colorCounts[color];
+	}
+
+	// Counting sort by color, stable so each color keeps the original constraint order
+	int32 colorStarts[b2_wideColorCount + 1];
+	int32 start = 0;
+	for (int32 color = 0; color <= b2_wideColorCount; ++color)
+	{
+		colorStarts[color] = start;
+		start += colorCounts[color];
+	}
+
+	int32* sorted = (int32*)m_allocator->Allocate(m_count * sizeof(int32));
+	for (int32 i = 0; i < m_count; ++i)
+	{
+		sorted[colorStarts[colors[i]]++] = i;
+	}
+
+	start = 0;
+	for (int32 color = 0; color <= b2_wideColorCount; ++color)
+	{
+		int32 end = start + colorCounts[color];
+		int32 i = start;
+
+		if (color < b2_wideColorCount)
+		{
+			for (; i + b2_wideLanes <= end; i += b2_wideLanes)
+			{
+				b2ContactConstraintWide* wc = m_wideConstraints + m_wideCount++;
+				for (int32 lane = 0; lane < b2_wideLanes; ++lane)
+				{
+					wc->constraintIndex[lane] = sorted[i + lane];
+				}
+			}
+		}
+
+		for (; i < end; ++i)
+		{
+			m_scalarIndices[m_scalarCount++] = sorted[i];
+		}
+
+		start = end;
+	}
+
+	m_allocator->Free(sorted);
+	m_allocator->Free(colors);
+	m_allocator->Free(bodyColors);
+}
+
+// Copies the initialized velocity constraints into their batches.
+void b2ContactSolver::PrepareWideConstraints()
+{
+	for (int32 i = 0; i < m_wideCount; ++i)
+	{
+		b2ContactConstraintWide* wc = m_wideConstraints + i;
+
+		for (int32 lane = 0; lane < b2_wideLanes; ++lane)
+		{
+			const b2ContactVelocityConstraint* vc = m_velocityConstraints + wc->constraintIndex[lane];
+			const b2VelocityConstraintPoint* cp1 = vc->points + 0;
+			const b2VelocityConstraintPoint* cp2 = vc->points + 1;
+			bool twoPoints = vc->pointCount == 2;
+
+			wc->indexA[lane] = vc->indexA;
+			wc->indexB[lane] = vc->indexB;
+			wc->invMassA[lane] = vc->invMassA;
+			wc->invIA[lane] = vc->invIA;
+			wc->invMassB[lane] = vc->invMassB;
+			wc->invIB[lane] = vc->invIB;
+			wc->normalX[lane] = vc->normal.x;
+			wc->normalY[lane] = vc->normal.y;
+			wc->friction[lane] = vc->friction;
+			wc->tangentSpeed[lane] = vc->tangentSpeed;
+
+			wc->rA1X[lane] = cp1->rA.x;
+			wc->rA1Y[lane] = cp1->rA.y;
+			wc->rB1X[lane] = cp1->rB.x;
+			wc->rB1Y[lane] = cp1->rB.y;
+			wc->normalMass1[lane] = cp1->normalMass;
+			wc->tangentMass1[lane] = cp1->tangentMass;
+			wc->velocityBias1[lane] = cp1->velocityBias;
+			wc->normalImpulse1[lane] = cp1->normalImpulse;
+			wc->tangentImpulse1[lane] = cp1->tangentImpulse;
+
+			wc->rA2X[lane] = twoPoints ? cp2->rA.x : 0.0f;
+			wc->rA2Y[lane] = twoPoints ? cp2->rA.y : 0.0f;
+			wc->rB2X[lane] = twoPoints ? cp2->rB.x : 0.0f;
+			wc->rB2Y[lane] = twoPoints ? cp2->rB.y : 0.0f;
+			wc->normalMass2[lane] = twoPoints ? cp2->normalMass : 0.0f;
+			wc->tangentMass2[lane] = twoPoints ? cp2->tangentMass : 0.0f;
+			wc->velocityBias2[lane] = twoPoints ? cp2->velocityBias : 0.0f;
+			wc->normalImpulse2[lane] = twoPoints ? cp2->normalImpulse : 0.0f;
+			wc->tangentImpulse2[lane] = twoPoints ? cp2->tangentImpulse : 0.0f;
+
+			// InitializeVelocityConstraints already dropped the second point where K is badly conditioned
+			wc->blockSolve[lane] = twoPoints ? 1.0f : 0.0f;
+			wc->k11[lane] = vc->K.ex.x;
+			wc->k12[lane] = vc->K.ex.y;
+			wc->k22[lane] = vc->K.ey.y;
+			wc->blockMass11[lane] = vc->normalMass.ex.x;
+			wc->blockMass12[lane] = vc->normalMass.ey.x;
+			wc->blockMass22[lane] = vc->normalMass.ey.y;
+		}
+	}
 }
 
 void b2ContactSolver::WarmStart()
@@ -296,31 +571,79 @@ void b2ContactSolver::WarmStart()
 
 void b2ContactSolver::SolveVelocityConstraints()
 {
+	if (m_wideCount > 0)
+	{
+		for (int32 i = 0; i < m_wideCount; ++i)
+		{
+			SolveWideVelocityConstraint(m_wideConstraints + i);
+		}
+
+		for (int32 i = 0; i < m_scalarCount; ++i)
+		{
+			SolveVelocityConstraint(m_velocityConstraints + m_scalarIndices[i]);
+		}
+		return;
+	}
+
 	for (int32 i = 0; i < m_count; ++i)
 	{
-		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
+		SolveVelocityConstraint(m_velocityConstraints + i);
+	}
+}
 
-		int32 indexA = vc->indexA;
-		int32 indexB = vc->indexB;
-		float mA = vc->invMassA;
-		float iA = vc->invIA;
-		float mB = vc->invMassB;
-		float iB = vc->invIB;
-		int32 pointCount = vc->pointCount;
+void b2ContactSolver::SolveVelocityConstraint(b2ContactVelocityConstraint* vc)
+{
+	int32 indexA = vc->indexA;
+	int32 indexB = vc->indexB;
+	float mA = vc->invMassA;
+	float iA = vc->invIA;
+	float mB = vc->invMassB;
+	float iB = vc->invIB;
+	int32 pointCount = vc->pointCount;
+
+	b2Vec2 vA = m_velocities[indexA].v;
+	float wA = m_velocities[indexA].w;
+	b2Vec2 vB = m_velocities[indexB].v;
+	float wB = m_velocities[indexB].w;
+
+	b2Vec2 normal = vc->normal;
+	b2Vec2 tangent = b2Cross(normal, 1.0f);
+	float friction = vc->friction;
+
+	b2Assert(pointCount == 1 || pointCount == 2);
+
+	// Solve tangent constraints first because non-penetration is more important
+	// than friction.
+	for (int32 j = 0; j < pointCount; ++j)
+	{
+		b2VelocityConstraintPoint* vcp = vc->points + j;
 
-		b2Vec2 vA = m_velocities[indexA].v;
-		float wA = m_velocities[indexA].w;
-		b2Vec2 vB = m_velocities[indexB].v;
-		float wB = m_velocities[indexB].w;
+		// Relative velocity at contact
+		b2Vec2 dv = vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA);
 
-		b2Vec2 normal = vc->normal;
-		b2Vec2 tangent = b2Cross(normal, 1.0f);
-		float friction = vc->friction;
+		// Compute tangent force
+		float vt = b2Dot(dv, tangent) - vc->tangentSpeed;
+		float lambda = vcp->tangentMass * (-vt);
+
+		// b2Clamp the accumulated force
+		float maxFriction = friction * vcp->normalImpulse;
+		float newImpulse = b2Clamp(vcp->tangentImpulse + lambda, -maxFriction, maxFriction);
+		lambda = newImpulse - vcp->tangentImpulse;
+		vcp->tangentImpulse = newImpulse;
+
+		// Apply contact impulse
+		b2Vec2 P = lambda * tangent;
 
-		b2Assert(pointCount == 1 || pointCount == 2);
+		vA -= mA * P;
+		wA -= iA * b2Cross(vcp->rA, P);
 
-		// Solve tangent constraints first because non-penetration is more important
-		// than friction.
+		vB += mB * P;
+		wB += iB * b2Cross(vcp->rB, P);
+	}
+
+	// Solve normal constraints
+	if (pointCount == 1 || g_blockSolve == false)
+	{
 		for (int32 j = 0; j < pointCount; ++j)
 		{
 			b2VelocityConstraintPoint* vcp = vc->points + j;
@@ -328,286 +651,450 @@ void b2ContactSolver::SolveVelocityConstraints()
 			// Relative velocity at contact
 			b2Vec2 dv = vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA);
 
-			// Compute tangent force
-			float vt = b2Dot(dv, tangent) - vc->tangentSpeed;
-			float lambda = vcp->tangentMass * (-vt);
+			// Compute normal impulse
+			float vn = b2Dot(dv, normal);
+			float lambda = -vcp->normalMass * (vn - vcp->velocityBias);
 
-			// b2Clamp the accumulated force
-			float maxFriction = friction * vcp->normalImpulse;
-			float newImpulse = b2Clamp(vcp->tangentImpulse + lambda, -maxFriction, maxFriction);
-			lambda = newImpulse - vcp->tangentImpulse;
-			vcp->tangentImpulse = newImpulse;
+			// b2Clamp the accumulated impulse
+			float newImpulse = b2Max(vcp->normalImpulse + lambda, 0.0f);
+			lambda = newImpulse - vcp->normalImpulse;
+			vcp->normalImpulse = newImpulse;
 
 			// Apply contact impulse
-			b2Vec2 P = lambda * tangent;
-
+			b2Vec2 P = lambda * normal;
 			vA -= mA * P;
 			wA -= iA * b2Cross(vcp->rA, P);
 
 			vB += mB * P;
 			wB += iB * b2Cross(vcp->rB, P);
 		}
-
-		// Solve normal constraints
-		if (pointCount == 1 || g_blockSolve == false)
-		{
-			for (int32 j = 0; j < pointCount; ++j)
-			{
-				b2VelocityConstraintPoint* vcp = vc->points + j;
-
-				// Relative velocity at contact
-				b2Vec2 dv = vB + b2Cross(wB, vcp->rB) - vA - b2Cross(wA, vcp->rA);
-
-				// Compute normal impulse
-				float vn = b2Dot(dv, normal);
-				float lambda = -vcp->normalMass * (vn - vcp->velocityBias);
-
-				// b2Clamp the accumulated impulse
-				float newImpulse = b2Max(vcp->normalImpulse + lambda, 0.0f);
-				lambda = newImpulse - vcp->normalImpulse;
-				vcp->normalImpulse = newImpulse;
-
-				// Apply contact impulse
-				b2Vec2 P = lambda * normal;
-				vA -= mA * P;
-				wA -= iA * b2Cross(vcp->rA, P);
-
-				vB += mB * P;
-				wB += iB * b2Cross(vcp->rB, P);
-			}
-		}
-		else
+	}
+	else
+	{
+		// Block solver developed in collaboration with Dirk Gregorius (back in 01/07 on Box2D_Lite).
+		// Build the mini LCP for this contact patch
+		//
+		// vn = A * x + b, vn >= 0, x >= 0 and vn_i * x_i = 0 with i = 1..2
+		//
+		// A = J * W * JT and J = ( -n, -r1 x n, n, r2 x n )
+		// b = vn0 - velocityBias
+		//
+		// The system is solved using the "Total enumeration method" (s. Murty). The complementary constraint vn_i * x_i
+		// implies that we must have in any solution either vn_i = 0 or x_i = 0. So for the 2D contact problem the cases
+		// vn1 = 0 and vn2 = 0, x1 = 0 and x2 = 0, x1 = 0 and vn2 = 0, x2 = 0 and vn1 = 0 need to be tested. The first valid
+		// solution that satisfies the problem is chosen.
+		// 
+		// In order to account of the accumulated impulse 'a' (because of the iterative nature of the solver which only requires
+		// that the accumulated impulse is clamped and not the incremental impulse) we change the impulse variable (x_i).
+		//
+		// Substitute:
+		// 
+		// x = a + d
+		// 
+		// a := old total impulse
+		// x := new total impulse
+		// d := incremental impulse 
+		//
+		// For the current iteration we extend the formula for the incremental impulse
+		// to compute the new total impulse:
+		//
+		// vn = A * d + b
+		//    = A * (x - a) + b
+		//    = A * x + b - A * a
+		//    = A * x + b'
+		// b' = b - A * a;
+
+		b2VelocityConstraintPoint* cp1 = vc->points + 0;
+		b2VelocityConstraintPoint* cp2 = vc->points + 1;
+
+		b2Vec2 a(cp1->normalImpulse, cp2->normalImpulse);
+		b2Assert(a.x >= 0.0f && a.y >= 0.0f);
+
+		// Relative velocity at contact
+		b2Vec2 dv1 = vB + b2Cross(wB, cp1->rB) - vA - b2Cross(wA, cp1->rA);
+		b2Vec2 dv2 = vB + b2Cross(wB, cp2->rB) - vA - b2Cross(wA, cp2->rA);
+
+		// Compute normal velocity
+		float vn1 = b2Dot(dv1, normal);
+		float vn2 = b2Dot(dv2, normal);
+
+		b2Vec2 b;
+		b.x = vn1 - cp1->velocityBias;
+		b.y = vn2 - cp2->velocityBias;
+
+		// Compute b'
+		b -= b2Mul(vc->K, a);
+
+		const float k_errorTol = 1e-3f;
+		B2_NOT_USED(k_errorTol);
+
+		for (;;)
 		{
-			// Block solver developed in collaboration with Dirk Gregorius (back in 01/07 on Box2D_Lite).
-			// Build the mini LCP for this contact patch
 			//
-			// vn = A * x + b, vn >= 0, x >= 0 and vn_i * x_i = 0 with i = 1..2
+			// Case 1: vn = 0
 			//
-			// A = J * W * JT and J = ( -n, -r1 x n, n, r2 x n )
-			// b = vn0 - velocityBias
+			// 0 = A * x + b'
 			//
-			// The system is solved using the "Total enumeration method" (s. Murty). The complementary constraint vn_i * x_i
-			// implies that we must have in any solution either vn_i = 0 or x_i = 0. So for the 2D contact problem the cases
-			// vn1 = 0 and vn2 = 0, x1 = 0 and x2 = 0, x1 = 0 and vn2 = 0, x2 = 0 and vn1 = 0 need to be tested. The first valid
-			// solution that satisfies the problem is chosen.
-			// 
-			// In order to account of the accumulated impulse 'a' (because of the iterative nature of the solver which only requires
-			// that the accumulated impulse is clamped and not the incremental impulse) we change the impulse variable (x_i).
-			//
-			// Substitute:
-			// 
-			// x = a + d
-			// 
-			// a := old total impulse
-			// x := new total impulse
-			// d := incremental impulse 
+			// Solve for x:
 			//
-			// For the current iteration we extend the formula for the incremental impulse
-			// to compute the new total impulse:
+			// x = - inv(A) * b'
 			//
-			// vn = A * d + b
-			//    = A * (x - a) + b
-			//    = A * x + b - A * a
-			//    = A * x + b'
-			// b' = b - A * a;
-
-			b2VelocityConstraintPoint* cp1 = vc->points + 0;
-			b2VelocityConstraintPoint* cp2 = vc->points + 1;
-
-			b2Vec2 a(cp1->normalImpulse, cp2->normalImpulse);
-			b2Assert(a.x >= 0.0f && a.y >= 0.0f);
+			b2Vec2 x = - b2Mul(vc->normalMass, b);
 
-			// Relative velocity at contact
-			b2Vec2 dv1 = vB + b2Cross(wB, cp1->rB) - vA - b2Cross(wA, cp1->rA);
-			b2Vec2 dv2 = vB + b2Cross(wB, cp2->rB) - vA - b2Cross(wA, cp2->rA);
-
-			// Compute normal velocity
-			float vn1 = b2Dot(dv1, normal);
-			float vn2 = b2Dot(dv2, normal);
-
-			b2Vec2 b;
-			b.x = vn1 - cp1->velocityBias;
-			b.y = vn2 - cp2->velocityBias;
-
-			// Compute b'
-			b -= b2Mul(vc->K, a);
-
-			const float k_errorTol = 1e-3f;
-			B2_NOT_USED(k_errorTol);
-
-			for (;;)
+			if (x.x >= 0.0f && x.y >= 0.0f)
 			{
-				//
-				// Case 1: vn = 0
-				//
-				// 0 = A * x + b'
-				//
-				// Solve for x:
-				//
-				// x = - inv(A) * b'
-				//
-				b2Vec2 x = - b2Mul(vc->normalMass, b);
-
-				if (x.x >= 0.0f && x.y >= 0.0f)
-				{
-					// Get the incremental impulse
-					b2Vec2 d = x - a;
+				// Get the incremental impulse
+				b2Vec2 d = x - a;
 
-					// Apply incremental impulse
-					b2Vec2 P1 = d.x * normal;
-					b2Vec2 P2 = d.y * normal;
-					vA -= mA * (P1 + P2);
-					wA -= iA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
+				// Apply incremental impulse
+				b2Vec2 P1 = d.x * normal;
+				b2Vec2 P2 = d.y * normal;
+				vA -= mA * (P1 + P2);
+				wA -= iA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
 
-					vB += mB * (P1 + P2);
-					wB += iB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
+				vB += mB * (P1 + P2);
+				wB += iB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
 
-					// Accumulate
-					cp1->normalImpulse = x.x;
-					cp2->normalImpulse = x.y;
+				// Accumulate
+				cp1->normalImpulse = x.x;
+				cp2->normalImpulse = x.y;
 
 #if B2_DEBUG_SOLVER == 1
-					// Postconditions
-					dv1 = vB + b2Cross(wB, cp1->rB) - vA - b2Cross(wA, cp1->rA);
-					dv2 = vB + b2Cross(wB, cp2->rB) - vA - b2Cross(wA, cp2->rA);
+				// Postconditions
+				dv1 = vB + b2Cross(wB, cp1->rB) - vA - b2Cross(wA, cp1->rA);
+				dv2 = vB + b2Cross(wB, cp2->rB) - vA - b2Cross(wA, cp2->rA);
 
-					// Compute normal velocity
-					vn1 = b2Dot(dv1, normal);
-					vn2 = b2Dot(dv2, normal);
+				// Compute normal velocity
+				vn1 = b2Dot(dv1, normal);
+				vn2 = b2Dot(dv2, normal);
 
-					b2Assert(b2Abs(vn1 - cp1->velocityBias) < k_errorTol);
-					b2Assert(b2Abs(vn2 - cp2->velocityBias) < k_errorTol);
+				b2Assert(b2Abs(vn1 - cp1->velocityBias) < k_errorTol);
+				b2Assert(b2Abs(vn2 - cp2->velocityBias) < k_errorTol);
 #endif
-					break;
-				}
+				break;
+			}
 
-				//
-				// Case 2: vn1 = 0 and x2 = 0
-				//
-				//   0 = a11 * x1 + a12 * 0 + b1' 
-				// vn2 = a21 * x1 + a22 * 0 + b2'
-				//
-				x.x = - cp1->normalMass * b.x;
-				x.y = 0.0f;
-				vn1 = 0.0f;
-				vn2 = vc->K.ex.y * x.x + b.y;
-				if (x.x >= 0.0f && vn2 >= 0.0f)
-				{
-					// Get the incremental impulse
-					b2Vec2 d = x - a;
+			//
+			// Case 2: vn1 = 0 and x2 = 0
+			//
+			//   0 = a11 * x1 + a12 * 0 + b1' 
+			// vn2 = a21 * x1 + a22 * 0 + b2'
+			//
+			x.x = - cp1->normalMass * b.x;
+			x.y = 0.0f;
+			vn1 = 0.0f;
+			vn2 = vc->K.ex.y * x.x + b.y;
+			if (x.x >= 0.0f && vn2 >= 0.0f)
+			{
+				// Get the incremental impulse
+				b2Vec2 d = x - a;
 
-					// Apply incremental impulse
-					b2Vec2 P1 = d.x * normal;
-					b2Vec2 P2 = d.y * normal;
-					vA -= mA * (P1 + P2);
-					wA -= iA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
+				// Apply incremental impulse
+				b2Vec2 P1 = d.x * normal;
+				b2Vec2 P2 = d.y * normal;
+				vA -= mA * (P1 + P2);
+				wA -= iA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
 
-					vB += mB * (P1 + P2);
-					wB += iB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
+				vB += mB * (P1 + P2);
+				wB += iB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
 
-					// Accumulate
-					cp1->normalImpulse = x.x;
-					cp2->normalImpulse = x.y;
+				// Accumulate
+				cp1->normalImpulse = x.x;
+				cp2->normalImpulse = x.y;
 
 #if B2_DEBUG_SOLVER == 1
-					// Postconditions
-					dv1 = vB + b2Cross(wB, cp1->rB) - vA - b2Cross(wA, cp1->rA);
+				// Postconditions
+				dv1 = vB + b2Cross(wB, cp1->rB) - vA - b2Cross(wA, cp1->rA);
 
-					// Compute normal velocity
-					vn1 = b2Dot(dv1, normal);
+				// Compute normal velocity
+				vn1 = b2Dot(dv1, normal);
 
-					b2Assert(b2Abs(vn1 - cp1->velocityBias) < k_errorTol);
+				b2Assert(b2Abs(vn1 - cp1->velocityBias) < k_errorTol);
 #endif
-					break;
-				}
+				break;
+			}
 
 
-				//
-				// Case 3: vn2 = 0 and x1 = 0
-				//
-				// vn1 = a11 * 0 + a12 * x2 + b1' 
-				//   0 = a21 * 0 + a22 * x2 + b2'
-				//
-				x.x = 0.0f;
-				x.y = - cp2->normalMass * b.y;
-				vn1 = vc->K.ey.x * x.y + b.x;
-				vn2 = 0.0f;
+			//
+			// Case 3: vn2 = 0 and x1 = 0
+			//
+			// vn1 = a11 * 0 + a12 * x2 + b1' 
+			//   0 = a21 * 0 + a22 * x2 + b2'
+			//
+			x.x = 0.0f;
+			x.y = - cp2->normalMass * b.y;
+			vn1 = vc->K.ey.x * x.y + b.x;
+			vn2 = 0.0f;
 
-				if (x.y >= 0.0f && vn1 >= 0.0f)
-				{
-					// Resubstitute for the incremental impulse
-					b2Vec2 d = x - a;
+			if (x.y >= 0.0f && vn1 >= 0.0f)
+			{
+				// Resubstitute for the incremental impulse
+				b2Vec2 d = x - a;
 
-					// Apply incremental impulse
-					b2Vec2 P1 = d.x * normal;
-					b2Vec2 P2 = d.y * normal;
-					vA -= mA * (P1 + P2);
-					wA -= iA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
+				// Apply incremental impulse
+				b2Vec2 P1 = d.x * normal;
+				b2Vec2 P2 = d.y * normal;
+				vA -= mA * (P1 + P2);
+				wA -= iA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
 
-					vB += mB * (P1 + P2);
-					wB += iB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
+				vB += mB * (P1 + P2);
+				wB += iB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
 
-					// Accumulate
-					cp1->normalImpulse = x.x;
-					cp2->normalImpulse = x.y;
+				// Accumulate
+				cp1->normalImpulse = x.x;
+				cp2->normalImpulse = x.y;
 
 #if B2_DEBUG_SOLVER == 1
-					// Postconditions
-					dv2 = vB + b2Cross(wB, cp2->rB) - vA - b2Cross(wA, cp2->rA);
+				// Postconditions
+				dv2 = vB + b2Cross(wB, cp2->rB) - vA - b2Cross(wA, cp2->rA);
 
-					// Compute normal velocity
-					vn2 = b2Dot(dv2, normal);
+				// Compute normal velocity
+				vn2 = b2Dot(dv2, normal);
 
-					b2Assert(b2Abs(vn2 - cp2->velocityBias) < k_errorTol);
+				b2Assert(b2Abs(vn2 - cp2->velocityBias) < k_errorTol);
 #endif
-					break;
-				}
-
-				//
-				// Case 4: x1 = 0 and x2 = 0
-				// 
-				// vn1 = b1
-				// vn2 = b2;
-				x.x = 0.0f;
-				x.y = 0.0f;
-				vn1 = b.x;
-				vn2 = b.y;
-
-				if (vn1 >= 0.0f && vn2 >= 0.0f )
-				{
-					// Resubstitute for the incremental impulse
-					b2Vec2 d = x - a;
+				break;
+			}
 
-					// Apply incremental impulse
-					b2Vec2 P1 = d.x * normal;
-					b2Vec2 P2 = d.y * normal;
-					vA -= mA * (P1 + P2);
-					wA -= iA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
+			//
+			// Case 4: x1 = 0 and x2 = 0
+			// 
+			// vn1 = b1
+			// vn2 = b2;
+			x.x = 0.0f;
+			x.y = 0.0f;
+			vn1 = b.x;
+			vn2 = b.y;
+
+			if (vn1 >= 0.0f && vn2 >= 0.0f )
+			{
+				// Resubstitute for the incremental impulse
+				b2Vec2 d = x - a;
 
-					vB += mB * (P1 + P2);
-					wB += iB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
+				// Apply incremental impulse
+				b2Vec2 P1 = d.x * normal;
+				b2Vec2 P2 = d.y * normal;
+				vA -= mA * (P1 + P2);
+				wA -= iA * (b2Cross(cp1->rA, P1) + b2Cross(cp2->rA, P2));
 
-					// Accumulate
-					cp1->normalImpulse = x.x;
-					cp2->normalImpulse = x.y;
+				vB += mB * (P1 + P2);
+				wB += iB * (b2Cross(cp1->rB, P1) + b2Cross(cp2->rB, P2));
 
-					break;
-				}
+				// Accumulate
+				cp1->normalImpulse = x.x;
+				cp2->normalImpulse = x.y;
 
-				// No solution, give up. This is hit sometimes, but it doesn't seem to matter.
 				break;
 			}
+
+			// No solution, give up. This is hit sometimes, but it doesn't seem to matter.
+			break;
 		}
+	}
 
-		m_velocities[indexA].v = vA;
-		m_velocities[indexA].w = wA;
-		m_velocities[indexB].v = vB;
-		m_velocities[indexB].w = wB;
+	m_velocities[indexA].v = vA;
+	m_velocities[indexA].w = wA;
+	m_velocities[indexB].v = vB;
+	m_velocities[indexB].w = wB;
+}
+
+// The same steps as SolveVelocityConstraint for four constraints at once. Where the scalar block solver
+// stops at the first valid case, this computes every case and keeps the first valid one per lane.
+void b2ContactSolver::SolveWideVelocityConstraint(b2ContactConstraintWide* wc)
+{
+	float vAXs[b2_wideLanes], vAYs[b2_wideLanes], wAs[b2_wideLanes];
+	float vBXs[b2_wideLanes], vBYs[b2_wideLanes], wBs[b2_wideLanes];
+	for (int32 lane = 0; lane < b2_wideLanes; ++lane)
+	{
+		const b2Velocity& velocityA = m_velocities[wc->indexA[lane]];
+		const b2Velocity& velocityB = m_velocities[wc->indexB[lane]];
+		vAXs[lane] = velocityA.v.x;
+		vAYs[lane] = velocityA.v.y;
+		wAs[lane] = velocityA.w;
+		vBXs[lane] = velocityB.v.x;
+		vBYs[lane] = velocityB.v.y;
+		wBs[lane] = velocityB.w;
+	}
+
+	b2FloatW vAX = b2LoadW(vAXs), vAY = b2LoadW(vAYs), wA = b2LoadW(wAs);
+	b2FloatW vBX = b2LoadW(vBXs), vBY = b2LoadW(vBYs), wB = b2LoadW(wBs);
+
+	b2FloatW mA = b2LoadW(wc->invMassA), iA = b2LoadW(wc->invIA);
+	b2FloatW mB = b2LoadW(wc->invMassB), iB = b2LoadW(wc->invIB);
+	b2FloatW normalX = b2LoadW(wc->normalX), normalY = b2LoadW(wc->normalY);
+	b2FloatW zero = b2SplatW(0.0f);
+
+	// tangent = b2Cross(normal, 1.0f)
+	b2FloatW tangentX = normalY;
+	b2FloatW tangentY = b2SubW(zero, normalX);
+	b2FloatW friction = b2LoadW(wc->friction);
+	b2FloatW tangentSpeed = b2LoadW(wc->tangentSpeed);
+
+	b2FloatW rA1X = b2LoadW(wc->rA1X), rA1Y = b2LoadW(wc->rA1Y), rB1X = b2LoadW(wc->rB1X), rB1Y = b2LoadW(wc->rB1Y);
+	b2FloatW rA2X = b2LoadW(wc->rA2X), rA2Y = b2LoadW(wc->rA2Y), rB2X = b2LoadW(wc->rB2X), rB2Y = b2LoadW(wc->rB2Y);
+
+	// Solve tangent constraints first because non-penetration is more important
+	// than friction. A missing second point has zero mass and zero impulse, so it changes nothing.
+	b2FloatW normalImpulse1 = b2LoadW(wc->normalImpulse1);
+	b2FloatW normalImpulse2 = b2LoadW(wc->normalImpulse2);
+	b2FloatW tangentImpulse1 = b2LoadW(wc->tangentImpulse1);
+	b2FloatW tangentImpulse2 = b2LoadW(wc->tangentImpulse2);
+	b2FloatW tangentMass1 = b2LoadW(wc->tangentMass1);
+	b2FloatW tangentMass2 = b2LoadW(wc->tangentMass2);
+
+	for (int32 j = 0; j < 2; ++j)
+	{
+		b2FloatW rAX = j == 0 ? rA1X : rA2X, rAY = j == 0 ? rA1Y : rA2Y;
+		b2FloatW rBX = j == 0 ? rB1X : rB2X, rBY = j == 0 ? rB1Y : rB2Y;
+		b2FloatW& tangentImpulse = j == 0 ? tangentImpulse1 : tangentImpulse2;
+		b2FloatW tangentMass = j == 0 ? tangentMass1 : tangentMass2;
+		b2FloatW normalImpulse = j == 0 ? normalImpulse1 : normalImpulse2;
+
+		// Relative velocity at contact
+		b2FloatW dvX = b2AddW(b2SubW(b2SubW(vBX, b2MulW(wB, rBY)), vAX), b2MulW(wA, rAY));
+		b2FloatW dvY = b2SubW(b2SubW(b2AddW(vBY, b2MulW(wB, rBX)), vAY), b2MulW(wA, rAX));
+
+		// Compute tangent force
+		b2FloatW vt = b2SubW(b2AddW(b2MulW(dvX, tangentX), b2MulW(dvY, tangentY)), tangentSpeed);
+		b2FloatW lambda = b2MulW(tangentMass, b2SubW(zero, vt));
+
+		// b2Clamp the accumulated force
+		b2FloatW maxFriction = b2MulW(friction, normalImpulse);
+		b2FloatW newImpulse = b2MaxW(b2SubW(zero, maxFriction), b2MinW(b2AddW(tangentImpulse, lambda), maxFriction));
+		lambda = b2SubW(newImpulse, tangentImpulse);
+		tangentImpulse = newImpulse;
+
+		// Apply contact impulse
+		b2FloatW PX = b2MulW(lambda, tangentX);
+		b2FloatW PY = b2MulW(lambda, tangentY);
+
+		vAX = b2SubW(vAX, b2MulW(mA, PX));
+		vAY = b2SubW(vAY, b2MulW(mA, PY));
+		wA = b2SubW(wA, b2MulW(iA, b2SubW(b2MulW(rAX, PY), b2MulW(rAY, PX))));
+
+		vBX = b2AddW(vBX, b2MulW(mB, PX));
+		vBY = b2AddW(vBY, b2MulW(mB, PY));
+		wB = b2AddW(wB, b2MulW(iB, b2SubW(b2MulW(rBX, PY), b2MulW(rBY, PX))));
+	}
+
+	// Solve normal constraints
+	b2FloatW dv1X = b2AddW(b2SubW(b2SubW(vBX, b2MulW(wB, rB1Y)), vAX), b2MulW(wA, rA1Y));
+	b2FloatW dv1Y = b2SubW(b2SubW(b2AddW(vBY, b2MulW(wB, rB1X)), vAY), b2MulW(wA, rA1X));
+	b2FloatW dv2X = b2AddW(b2SubW(b2SubW(vBX, b2MulW(wB, rB2Y)), vAX), b2MulW(wA, rA2Y));
+	b2FloatW dv2Y = b2SubW(b2SubW(b2AddW(vBY, b2MulW(wB, rB2X)), vAY), b2MulW(wA, rA2X));
+
+	b2FloatW vn1 = b2AddW(b2MulW(dv1X, normalX), b2MulW(dv1Y, normalY));
+	b2FloatW vn2 = b2AddW(b2MulW(dv2X, normalX), b2MulW(dv2Y, normalY));
+
+	b2FloatW normalMass1 = b2LoadW(wc->normalMass1);
+	b2FloatW normalMass2 = b2LoadW(wc->normalMass2);
+	b2FloatW velocityBias1 = b2LoadW(wc->velocityBias1);
+	b2FloatW velocityBias2 = b2LoadW(wc->velocityBias2);
+
+	// Single point: x1 = max(a1 - m1 * (vn1 - bias1), 0)
+	b2FloatW single = b2MaxW(b2SubW(normalImpulse1, b2MulW(normalMass1, b2SubW(vn1, velocityBias1))), zero);
+
+	// Block solver, see SolveVelocityConstraint. b' = b - K * a
+	b2FloatW k12 = b2LoadW(wc->k12);
+	b2FloatW b1 = b2SubW(vn1, velocityBias1);
+	b2FloatW b2 = b2SubW(vn2, velocityBias2);
+	b1 = b2SubW(b1, b2AddW(b2MulW(b2LoadW(wc->k11), normalImpulse1), b2MulW(k12, normalImpulse2)));
+	b2 = b2SubW(b2, b2AddW(b2MulW(k12, normalImpulse1), b2MulW(b2LoadW(wc->k22), normalImpulse2)));
+
+	// No valid case leaves the impulses as they were
+	b2FloatW x1 = normalImpulse1;
+	b2FloatW x2 = normalImpulse2;
+
+	// Case 4: x1 = 0 and x2 = 0
+	b2FloatW valid = b2AndW(b2GreaterEqualW(b1, zero), b2GreaterEqualW(b2, zero));
+	x1 = b2BlendW(x1, zero, valid);
+	x2 = b2BlendW(x2, zero, valid);
+
+	// Case 3: vn2 = 0 and x1 = 0
+	b2FloatW case3X2 = b2SubW(zero, b2MulW(normalMass2, b2));
+	b2FloatW case3Vn1 = b2AddW(b2MulW(k12, case3X2), b1);
+	valid = b2AndW(b2GreaterEqualW(case3X2, zero), b2GreaterEqualW(case3Vn1, zero));
+	x1 = b2BlendW(x1, zero, valid);
+	x2 = b2BlendW(x2, case3X2, valid);
+
+	// Case 2: vn1 = 0 and x2 = 0
+	b2FloatW case2X1 = b2SubW(zero, b2MulW(normalMass1, b1));
+	b2FloatW case2Vn2 = b2AddW(b2MulW(k12, case2X1), b2);
+	valid = b2AndW(b2GreaterEqualW(case2X1, zero), b2GreaterEqualW(case2Vn2, zero));
+	x1 = b2BlendW(x1, case2X1, valid);
+	x2 = b2BlendW(x2, zero, valid);
+
+	// Case 1: vn = 0, x = -inv(K) * b'
+	b2FloatW blockMass12 = b2LoadW(wc->blockMass12);
+	b2FloatW case1X1 = b2SubW(zero, b2AddW(b2MulW(b2LoadW(wc->blockMass11), b1), b2MulW(blockMass12, b2)));
+	b2FloatW case1X2 = b2SubW(zero, b2AddW(b2MulW(blockMass12, b1), b2MulW(b2LoadW(wc->blockMass22), b2)));
+	valid = b2AndW(b2GreaterEqualW(case1X1, zero), b2GreaterEqualW(case1X2, zero));
+	x1 = b2BlendW(x1, case1X1, valid);
+	x2 = b2BlendW(x2, case1X2, valid);
+
+	b2FloatW blockSolve = b2GreaterEqualW(b2LoadW(wc->blockSolve), b2SplatW(0.5f));
+	x1 = b2BlendW(single, x1, blockSolve);
+	x2 = b2BlendW(normalImpulse2, x2, blockSolve);
+
+	// Apply the incremental impulse
+	b2FloatW d1 = b2SubW(x1, normalImpulse1);
+	b2FloatW d2 = b2SubW(x2, normalImpulse2);
+	b2FloatW P1X = b2MulW(d1, normalX), P1Y = b2MulW(d1, normalY);
+	b2FloatW P2X = b2MulW(d2, normalX), P2Y = b2MulW(d2, normalY);
+	b2FloatW PX = b2AddW(P1X, P2X), PY = b2AddW(P1Y, P2Y);
+
+	vAX = b2SubW(vAX, b2MulW(mA, PX));
+	vAY = b2SubW(vAY, b2MulW(mA, PY));
+	wA = b2SubW(wA, b2MulW(iA, b2AddW(b2SubW(b2MulW(rA1X, P1Y), b2MulW(rA1Y, P1X)), b2SubW(b2MulW(rA2X, P2Y), b2MulW(rA2Y, P2X)))));
+
+	vBX = b2AddW(vBX, b2MulW(mB, PX));
+	vBY = b2AddW(vBY, b2MulW(mB, PY));
+	wB = b2AddW(wB, b2MulW(iB, b2AddW(b2SubW(b2MulW(rB1X, P1Y), b2MulW(rB1Y, P1X)), b2SubW(b2MulW(rB2X, P2Y), b2MulW(rB2Y, P2X)))));
+
+	b2StoreW(wc->normalImpulse1, x1);
+	b2StoreW(wc->normalImpulse2, x2);
+	b2StoreW(wc->tangentImpulse1, tangentImpulse1);
+	b2StoreW(wc->tangentImpulse2, tangentImpulse2);
+
+	// Bodies are unique within a batch except static and kinematic ones, which come back unchanged
+	b2StoreW(vAXs, vAX);
+	b2StoreW(vAYs, vAY);
+	b2StoreW(wAs, wA);
+	b2StoreW(vBXs, vBX);
+	b2StoreW(vBYs, vBY);
+	b2StoreW(wBs, wB);
+	for (int32 lane = 0; lane < b2_wideLanes; ++lane)
+	{
+		b2Velocity& velocityA = m_velocities[wc->indexA[lane]];
+		b2Velocity& velocityB = m_velocities[wc->indexB[lane]];
+		velocityA.v.Set(vAXs[lane], vAYs[lane]);
+		velocityA.w = wAs[lane];
+		velocityB.v.Set(vBXs[lane], vBYs[lane]);
+		velocityB.w = wBs[lane];
 	}
 }
 
 void b2ContactSolver::StoreImpulses()
 {
+	// Copy the impulses out of the batches first, b2Island::Report reads them from the velocity constraints too
+	for (int32 i = 0; i < m_wideCount; ++i)
+	{
+		const b2ContactConstraintWide* wc = m_wideConstraints + i;
+
+		for (int32 lane = 0; lane < b2_wideLanes; ++lane)
+		{
+			b2ContactVelocityConstraint* vc = m_velocityConstraints + wc->constraintIndex[lane];
+			vc->points[0].normalImpulse = wc->normalImpulse1[lane];
+			vc->points[0].tangentImpulse = wc->tangentImpulse1[lane];
+
+			if (vc->pointCount == 2)
+			{
+				vc->points[1].normalImpulse = wc->normalImpulse2[lane];
+				vc->points[1].tangentImpulse = wc->tangentImpulse2[lane];
+			}
+		}
+	}
+
 	for (int32 i = 0; i < m_count; ++i)
 	{
 		b2ContactVelocityConstraint* vc = m_velocityConstraints + i;
@@ -34,11 +34,46 @@
 #include "box2d/b2_fixture.h"
 #include "box2d/b2_polygon_shape.h"
 #include "box2d/b2_pulley_joint.h"
+#include "box2d/b2_thread_pool.h"
 #include "box2d/b2_time_of_impact.h"
 #include "box2d/b2_timer.h"
 #include "box2d/b2_world.h"
 
+#include <algorithm>
 #include <new>
+#include <vector>
+
+// Below this many bodies waking the workers costs more than solving on one thread
+static const int32 b2_minParallelSolveBodies = 32;
+
+// The islands of one parallel solve, built before any of them is solved. Kept between steps so the
+// lists only allocate while the world grows.
+struct b2ParallelIslands
+{
+	struct Island
+	{
+		int32 bodyStart;
+		int32 bodyCount;
+		int32 contactStart;
+		int32 contactCount;
+		int32 jointStart;
+		int32 jointCount;
+		b2Profile profile;
+	};
+
+	std::vector<Island> islands;
+	std::vector<int32> order;
+	std::vector<b2Body*> bodies;
+	std::vector<b2Contact*> contacts;
+	std::vector<b2Joint*> joints;
+	std::vector<b2ContactImpulse> impulses;
+	std::vector<b2Body*> stack;
+
+	b2World* world;
+	const b2TimeStep* step;
+	int32 staticCount;
+	bool reportImpulses;
+};
 
 b2World::b2World(const b2Vec2& gravity)
 {
@@ -54,6 +89,7 @@ b2World::b2World(const b2Vec2& gravity)
 	m_warmStarting = true;
 	m_continuousPhysics = true;
 	m_subStepping = false;
+	m_wideContacts = false;
 
 	m_stepComplete = true;
 
@@ -69,10 +105,16 @@ b2World::b2World(const b2Vec2& gravity)
 	m_contactManager.m_allocator = &m_blockAllocator;
 
 	memset(&m_profile, 0, sizeof(b2Profile));
+
+	m_threadPool = nullptr;
+	m_parallelIslands = nullptr;
 }
 
 b2World::~b2World()
 {
+	delete m_threadPool;
+	delete m_parallelIslands;
+
 	// Some shapes allocate using b2Alloc.
 	b2Body* b = m_bodyList;
 	while (b)
@@ -390,6 +432,36 @@ void b2World::SetAllowSleeping(bool flag)
 	}
 }
 
+void b2World::SetWorkerCount(int32 count)
+{
+	b2Assert(IsLocked() == false);
+	b2Assert(count >= 0);
+	if (IsLocked() || count == GetWorkerCount())
+	{
+		return;
+	}
+
+	delete m_threadPool;
+	m_threadPool = nullptr;
+	m_contactManager.m_threadPool = nullptr;
+
+	if (count > 0)
+	{
+		m_threadPool = new b2ThreadPool(count);
+		m_contactManager.m_threadPool = m_threadPool;
+		if (m_parallelIslands == nullptr)
+		{
+			m_parallelIslands = new b2ParallelIslands();
+			m_parallelIslands->world = this;
+		}
+	}
+}
+
+int32 b2World::GetWorkerCount() const
+{
+	return m_threadPool == nullptr ? 0 : m_threadPool->GetWorkerCount();
+}
+
 // Find islands, integrate and solve constraints, solve position constraints
 void b2World::Solve(const b2TimeStep& step)
 {
@@ -397,13 +469,6 @@ void b2World::Solve(const b2TimeStep& step)
 	m_profile.solveVelocity = 0.0f;
 	m_profile.solvePosition = 0.0f;
 
-	// Size the island for the worst case.
-	b2Island island(m_bodyCount,
-					m_contactManager.m_contactCount,
-					m_jointCount,
-					&m_stackAllocator,
-					m_contactManager.m_contactListener);
-
 	// Clear all the island flags.
 	for (b2Body* b = m_bodyList; b; b = b->m_next)
 	{
@@ -418,7 +483,51 @@ void b2World::Solve(const b2TimeStep& step)
 		j->m_islandFlag = false;
 	}
 
-	// Build and simulate all awake islands.
+	if (m_threadPool != nullptr && m_bodyCount >= b2_minParallelSolveBodies)
+	{
+		SolveIslandsInParallel(step);
+	}
+	else
+	{
+		SolveIslands(step);
+	}
+
+	{
+		b2Timer timer;
+		// Synchronize fixtures, check for out of range bodies.
+		for (b2Body* b = m_bodyList; b; b = b->GetNext())
+		{
+			// If a body was not in an island then it did not move.
+			if ((b->m_flags & b2Body::e_islandFlag) == 0)
+			{
+				continue;
+			}
+
+			if (b->GetType() == b2_staticBody)
+			{
+				continue;
+			}
+
+			// Update fixtures (for broad-phase).
+			b->SynchronizeFixtures();
+		}
+
+		// Look for new contacts.
+		m_contactManager.FindNewContacts();
+		m_profile.broadphase = timer.GetMilliseconds();
+	}
+}
+
+// Build and simulate all awake islands, one after the other.
+void b2World::SolveIslands(const b2TimeStep& step)
+{
+	// Size the island for the worst case.
+	b2Island island(m_bodyCount,
+					m_contactManager.m_contactCount,
+					m_jointCount,
+					&m_stackAllocator,
+					m_contactManager.m_contactListener);
+
 	int32 stackSize = m_bodyCount;
 	b2Body** stack = (b2Body**)m_stackAllocator.Allocate(stackSize * sizeof(b2Body*));
 	for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
@@ -554,33 +663,255 @@ void b2World::Solve(const b2TimeStep& step)
 	}
 
 	m_stackAllocator.Free(stack);
+}
 
+// Islands share no dynamic bodies, contacts or joints, so once they are all built each one can be solved on
+// its own thread. The same static body can be in several islands, so static bodies get one index for the
+// whole step, ahead of every island's own bodies, and the solvers only read them. Islands are built in
+// the same order as SolveIslands and PostSolve is reported in that order after every island is done.
+void b2World::SolveIslandsInParallel(const b2TimeStep& step)
+{
+	b2ParallelIslands& batch = *m_parallelIslands;
+	batch.islands.clear();
+	batch.bodies.clear();
+	batch.contacts.clear();
+	batch.joints.clear();
+	batch.stack.resize(m_bodyCount);
+	batch.step = &step;
+	batch.staticCount = 0;
+	batch.reportImpulses = m_contactManager.m_contactListener != nullptr;
+
+	// Static bodies get their index the first time an island reaches them
+	for (b2Body* b = m_bodyList; b; b = b->m_next)
 	{
-		b2Timer timer;
-		// Synchronize fixtures, check for out of range bodies.
-		for (b2Body* b = m_bodyList; b; b = b->GetNext())
+		if (b->GetType() == b2_staticBody)
 		{
-			// If a body was not in an island then it did not move.
-			if ((b->m_flags & b2Body::e_islandFlag) == 0)
+			b->m_islandIndex = -1;
+		}
+	}
+
+	b2Body** stack = batch.stack.data();
+	for (b2Body* seed = m_bodyList; seed; seed = seed->m_next)
+	{
+		if (seed->m_flags & b2Body::e_islandFlag)
+		{
+			continue;
+		}
+
+		if (seed->IsAwake() == false || seed->IsEnabled() == false)
+		{
+			continue;
+		}
+
+		// The seed can be dynamic or kinematic.
+		if (seed->GetType() == b2_staticBody)
+		{
+			continue;
+		}
+
+		b2ParallelIslands::Island record;
+		record.bodyStart = int32(batch.bodies.size());
+		record.contactStart = int32(batch.contacts.size());
+		record.jointStart = int32(batch.joints.size());
+		int32 localIndex = 0;
+
+		int32 stackCount = 0;
+		stack[stackCount++] = seed;
+		seed->m_flags |= b2Body::e_islandFlag;
+
+		// Perform a depth first search (DFS) on the constraint graph.
+		while (stackCount > 0)
+		{
+			// Grab the next body off the stack and add it to the island.
+			b2Body* b = stack[--stackCount];
+			b2Assert(b->IsEnabled() == true);
+			batch.bodies.push_back(b);
+
+			// To keep islands as small as possible, we don't
+			// propagate islands across static bodies.
+			if (b->GetType() == b2_staticBody)
 			{
+				if (b->m_islandIndex < 0)
+				{
+					b->m_islandIndex = batch.staticCount++;
+				}
 				continue;
 			}
 
+			// Offset by the static count once every island is built.
+			b->m_islandIndex = localIndex++;
+
+			// Make sure the body is awake (without resetting sleep timer).
+			b->m_flags |= b2Body::e_awakeFlag;
+
+			// Search all contacts connected to this body.
+			for (b2ContactEdge* ce = b->m_contactList; ce; ce = ce->next)
+			{
+				b2Contact* contact = ce->contact;
+
+				// Has this contact already been added to an island?
+				if (contact->m_flags & b2Contact::e_islandFlag)
+				{
+					continue;
+				}
+
+				// Is this contact solid and touching?
+				if (contact->IsEnabled() == false ||
+					contact->IsTouching() == false)
+				{
+					continue;
+				}
+
+				// Skip sensors.
+				bool sensorA = contact->m_fixtureA->m_isSensor;
+				bool sensorB = contact->m_fixtureB->m_isSensor;
+				if (sensorA || sensorB)
+				{
+					continue;
+				}
+
+				batch.contacts.push_back(contact);
+				contact->m_flags |= b2Contact::e_islandFlag;
+
+				b2Body* other = ce->other;
+
+				// Was the other body already added to this island?
+				if (other->m_flags & b2Body::e_islandFlag)
+				{
+					continue;
+				}
+
+				b2Assert(stackCount < m_bodyCount);
+				stack[stackCount++] = other;
+				other->m_flags |= b2Body::e_islandFlag;
+			}
+
+			// Search all joints connect to this body.
+			for (b2JointEdge* je = b->m_jointList; je; je = je->next)
+			{
+				if (je->joint->m_islandFlag == true)
+				{
+					continue;
+				}
+
+				b2Body* other = je->other;
+
+				// Don't simulate joints connected to diabled bodies.
+				if (other->IsEnabled() == false)
+				{
+					continue;
+				}
+
+				batch.joints.push_back(je->joint);
+				je->joint->m_islandFlag = true;
+
+				if (other->m_flags & b2Body::e_islandFlag)
+				{
+					continue;
+				}
+
+				b2Assert(stackCount < m_bodyCount);
+				stack[stackCount++] = other;
+				other->m_flags |= b2Body::e_islandFlag;
+			}
+		}
+
+		record.bodyCount = int32(batch.bodies.size()) - record.bodyStart;
+		record.contactCount = int32(batch.contacts.size()) - record.contactStart;
+		record.jointCount = int32(batch.joints.size()) - record.jointStart;
+		batch.islands.push_back(record);
+
+		// Allow static bodies to participate in other islands.
+		for (int32 i = record.bodyStart; i < int32(batch.bodies.size()); ++i)
+		{
+			b2Body* b = batch.bodies[i];
 			if (b->GetType() == b2_staticBody)
 			{
-				continue;
+				b->m_flags &= ~b2Body::e_islandFlag;
 			}
+		}
+	}
 
-			// Update fixtures (for broad-phase).
-			b->SynchronizeFixtures();
+	for (b2Body* b : batch.bodies)
+	{
+		if (b->GetType() != b2_staticBody)
+		{
+			b->m_islandIndex += batch.staticCount;
 		}
+	}
 
-		// Look for new contacts.
-		m_contactManager.FindNewContacts();
-		m_profile.broadphase = timer.GetMilliseconds();
+	// Largest islands first, so one big island started last doesn't leave the other threads waiting
+	int32 islandCount = int32(batch.islands.size());
+	batch.order.resize(islandCount);
+	for (int32 i = 0; i < islandCount; ++i)
+	{
+		batch.order[i] = i;
+	}
+	std::stable_sort(batch.order.begin(), batch.order.end(), [&batch](int32 a, int32 b)
+	{
+		const b2ParallelIslands::Island& islandA = batch.islands[a];
+		const b2ParallelIslands::Island& islandB = batch.islands[b];
+		return islandA.bodyCount + islandA.contactCount > islandB.bodyCount + islandB.contactCount;
+	});
+
+	if (batch.reportImpulses)
+	{
+		batch.impulses.resize(batch.contacts.size());
+	}
+
+	m_threadPool->ParallelFor(islandCount, &b2World::SolveIslandTask, &batch);
+
+	b2ContactListener* listener = m_contactManager.m_contactListener;
+	for (const b2ParallelIslands::Island& record : batch.islands)
+	{
+		m_profile.solveInit += record.profile.solveInit;
+		m_profile.solveVelocity += record.profile.solveVelocity;
+		m_profile.solvePosition += record.profile.solvePosition;
+
+		if (batch.reportImpulses)
+		{
+			for (int32 i = record.contactStart; i < record.contactStart + record.contactCount; ++i)
+			{
+				listener->PostSolve(batch.contacts[i], &batch.impulses[i]);
+			}
+		}
 	}
 }
 
+void b2World::SolveIslandTask(void* context, int32 index, int32 threadIndex)
+{
+	b2ParallelIslands* batch = (b2ParallelIslands*)context;
+	b2ParallelIslands::Island& record = batch->islands[batch->order[index]];
+	b2World* world = batch->world;
+
+	// The state arrays are indexed by m_islandIndex, so they have room for every static body in the step
+	b2Island island(batch->staticCount + record.bodyCount,
+					record.contactCount,
+					record.jointCount,
+					world->m_threadPool->GetStackAllocator(threadIndex),
+					nullptr);
+
+	for (int32 i = 0; i < record.bodyCount; ++i)
+	{
+		island.AddIndexed(batch->bodies[record.bodyStart + i]);
+	}
+	for (int32 i = 0; i < record.contactCount; ++i)
+	{
+		island.Add(batch->contacts[record.contactStart + i]);
+	}
+	for (int32 i = 0; i < record.jointCount; ++i)
+	{
+		island.Add(batch->joints[record.jointStart + i]);
+	}
+
+	if (batch->reportImpulses)
+	{
+		island.m_deferredImpulses = batch->impulses.data() + record.contactStart;
+	}
+
+	island.Solve(&record.profile, *batch->step, world->m_gravity, world->m_allowSleep);
+}
+
 // Find TOI contacts and solve them.
 void b2World::SolveTOI(const b2TimeStep& step)
 {
@@ -868,6 +1199,7 @@ void b2World::SolveTOI(const b2TimeStep& step)
 		subStep.positionIterations = 20;
 		subStep.velocityIterations = step.velocityIterations;
 		subStep.warmStarting = false;
+		subStep.wideContacts = false;
 		island.SolveTOI(subStep, bA->m_islandIndex, bB->m_islandIndex);
 
 		// Reset island flags and synchronize broad-phase proxies.
@@ -931,6 +1263,7 @@ void b2World::Step(float dt, int32 velocityIterations, int32 positionIterations)
 	step.dtRatio = m_inv_dt0 * dt;
 
 	step.warmStarting = m_warmStarting;
+	step.wideContacts = m_wideContacts;
 	
 	// Update contacts. This is where some contacts are destroyed.
 	{
@@ -1257,6 +1590,17 @@ void b2World::ShiftOrigin(const b2Vec2& newOrigin)
 	m_contactManager.m_broadPhase.ShiftOrigin(newOrigin);
 }
 
+void b2World::RebuildBroadPhase()
+{
+	b2Assert(m_locked == false);
+	if (m_locked)
+	{
+		return;
+	}
+
+	m_contactManager.m_broadPhase.RebuildTrees();
+}
+
 void b2World::Dump()
 {
 	if (m_locked)
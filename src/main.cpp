@@ -3,6 +3,7 @@
 
 int main(int argc, char* argv[]) {
 	GameEngine engine;
+	engine.ParseCommandLine(argc, argv);
 	engine.Initialize();
 	engine.Run();
 